@@ -0,0 +1,125 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+#
+# Copyright 2021 Analog Devices, Inc.
+#
+# SPDX-License-Identifier: GPL-3.0-or-later
+#
+
+"""
+Measures the sustained frame rate of the OFDM radar receiver.
+
+The transmitter output is looped straight into the receiver, so the flowgraph runs as
+fast as the receive processing allows. Run it against two builds of the module to
+compare their frames/s. The time needed to construct the blocks is reported as well,
+once for a cold start and once with all FFTs already planned.
+"""
+
+import time
+from argparse import ArgumentParser
+
+import ofdmradar
+from gnuradio import blocks, gr
+from gnuradio.fft import window
+
+
+def parse_size(s):
+    carriers, symbols = s.lower().split("x")
+    return int(carriers), int(symbols)
+
+
+EFFORTS = {
+    "estimate": ofdmradar.fft_effort.ESTIMATE,
+    "measure": ofdmradar.fft_effort.MEASURE,
+    "patient": ofdmradar.fft_effort.PATIENT,
+}
+
+
+def make_params(carriers, symbols, padding, effort, wisdom):
+    return ofdmradar.ofdmradar_params(carriers,
+                                      symbols,
+                                      carriers * padding,
+                                      symbols * padding,
+                                      carriers // 8,
+                                      1,
+                                      carriers // 16,
+                                      window.WIN_BLACKMAN_hARRIS,
+                                      ofdmradar.get_constellation(
+                                          ofdmradar.modulation_scheme.QPSK),
+                                      0,
+                                      EFFORTS[effort],
+                                      wisdom)
+
+
+def parse_threads(s):
+    threads = []
+    for part in s.split(","):
+        if "-" in part:
+            first, last = part.split("-")
+            threads.extend(range(int(first), int(last) + 1))
+        else:
+            threads.append(int(part))
+    return threads
+
+
+def make_blocks(params, nthreads, frame_buffers):
+    tx = ofdmradar.ofdmradar_tx(params, "packet_len")
+    rx = ofdmradar.ofdmradar_rx(params, "packet_len", -1, nthreads, frame_buffers)
+    return tx, rx
+
+
+def startup_time(params, nthreads, frame_buffers):
+    start = time.perf_counter()
+    make_blocks(params, nthreads, frame_buffers)
+    return time.perf_counter() - start
+
+
+def run(params, frames, nthreads, frame_buffers):
+    tb = gr.top_block()
+    tx, rx = make_blocks(params, nthreads, frame_buffers)
+    head = blocks.head(gr.sizeof_gr_complex, frames * params.roi_length)
+    sink = blocks.null_sink(gr.sizeof_gr_complex)
+    tb.connect(tx, rx, head, sink)
+
+    start = time.perf_counter()
+    tb.run()
+    return frames / (time.perf_counter() - start)
+
+
+def main():
+    parser = ArgumentParser(description=__doc__)
+    parser.add_argument("--sizes", default="1024x64,4096x256",
+                        help="Comma separated list of CARRIERSxSYMBOLS")
+    parser.add_argument("--padding", type=int, default=1,
+                        help="Periodogram zero-padding factor on both axes")
+    parser.add_argument("--frames", type=int, default=200,
+                        help="Frames to process per measurement")
+    parser.add_argument("--threads", default="1",
+                        help="RX thread counts to measure, e.g. 1,2,4 or 1-16")
+    parser.add_argument("--frame-buffers", type=int, default=1,
+                        help="RX frame buffers, 2 or more pipelines the doppler stage")
+    parser.add_argument("--effort", choices=EFFORTS.keys(), default="measure",
+                        help="FFT planning effort")
+    parser.add_argument("--wisdom", default="",
+                        help="FFTW wisdom file to load and update")
+    args = parser.parse_args()
+
+    for size in args.sizes.split(","):
+        carriers, symbols = parse_size(size)
+        params = make_params(carriers, symbols, args.padding, args.effort, args.wisdom)
+        threads = parse_threads(args.threads)
+        cold = startup_time(params, threads[0], args.frame_buffers)
+        warm = startup_time(params, threads[0], args.frame_buffers)
+        print(f"{carriers}x{symbols} (padding {args.padding}, {args.effort}): "
+              f"cold start {cold:.3f} s, warm start {warm:.3f} s")
+        baseline = None
+        for nthreads in threads:
+            rate = run(params, args.frames, nthreads, args.frame_buffers)
+            baseline = baseline or rate
+            print(f"{carriers}x{symbols} (padding {args.padding}, {nthreads} threads, "
+                  f"{args.frame_buffers} frame buffers): "
+                  f"{rate:.1f} frames/s, speedup {rate / baseline:.2f}")
+
+
+if __name__ == "__main__":
+    main()
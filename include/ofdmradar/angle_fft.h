@@ -0,0 +1,66 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2021 Analog Devices, Inc.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef INCLUDED_OFDMRADAR_ANGLE_FFT_H
+#define INCLUDED_OFDMRADAR_ANGLE_FFT_H
+
+#include <gnuradio/sync_block.h>
+#include <ofdmradar/api.h>
+#include <ofdmradar/ofdmradar.h>
+
+namespace gr {
+namespace ofdmradar {
+
+/*!
+ * \brief Forms an angle dimension for every cell of the range-doppler-channel cubes
+ *        output by a multi-channel ofdmradar_rx
+ * \ingroup ofdmradar
+ *
+ * The channels of every cell are the elements of a uniform linear array with half
+ * wavelength spacing. They are phase calibrated with the gains received on the calib
+ * port, as published by array_calib, and beamformed by a zero padded FFT across the
+ * elements. Angle bin b looks at sin(angle) = 2 * (b - angle_bins / 2) / angle_bins,
+ * rounding angle_bins / 2 down, with the sign of the steering vectors of array_music.
+ * The power is divided by the number of elements, so the noise level stays that of a
+ * single channel.
+ *
+ * The output is a range-doppler-angle cube of angle_bins powers per cell, or with the
+ * max projection the range-doppler map of the strongest angle of every cell. The
+ * latter can be fed to cfar_detector or peak_extractor as integrated power. Its
+ * optional second output holds the angle of the maximum in radians.
+ */
+class OFDMRADAR_API angle_fft : virtual public gr::sync_block
+{
+public:
+    typedef std::shared_ptr<angle_fft> sptr;
+
+    /*!
+     * \brief Return a shared_ptr to a new instance of ofdmradar::angle_fft.
+     *
+     * To avoid accidental use of raw pointers, ofdmradar::angle_fft's
+     * constructor is in a private implementation
+     * class. ofdmradar::angle_fft::make is the public interface for
+     * creating new instances.
+     *
+     * \param ofdm_params    OFDM radar system parameters, which supply the FFT planning
+     *                       effort and wisdom file
+     * \param array_size     Number of elements, i.e. receiver channels
+     * \param angle_bins     Size of the zero padded angle FFT, at least array_size
+     * \param max_projection Output only the maximum over all angles of every cell
+     * \param nthreads       Threads sharing the cells, 0 uses all available cores
+     */
+    static sptr make(ofdmradar_params::sptr ofdm_params,
+                     int array_size,
+                     int angle_bins,
+                     bool max_projection = false,
+                     int nthreads = 1);
+};
+
+} // namespace ofdmradar
+} // namespace gr
+
+#endif /* INCLUDED_OFDMRADAR_ANGLE_FFT_H */
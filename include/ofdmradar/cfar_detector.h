@@ -0,0 +1,81 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2021 Analog Devices, Inc.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef INCLUDED_OFDMRADAR_CFAR_DETECTOR_H
+#define INCLUDED_OFDMRADAR_CFAR_DETECTOR_H
+
+#include <gnuradio/sync_block.h>
+#include <ofdmradar/api.h>
+#include <ofdmradar/ofdmradar.h>
+
+namespace gr {
+namespace ofdmradar {
+
+/*!
+ * How the noise level around a cell is estimated from its training cells. CA averages
+ * all of them, GO takes the greater of the averages of the cells at shorter and at
+ * longer range, both including those at the cell's own range, OS a given order
+ * statistic.
+ */
+enum class OFDMRADAR_API cfar_mode { CA, GO, OS };
+
+/*!
+ * \brief 2D CFAR detector on the range-doppler maps output by ofdmradar_rx
+ * \ingroup ofdmradar
+ *
+ * Every cell of a map is compared to the noise level estimated from the training
+ * cells around it. These form a window of 2 * (guard + train) + 1 bins in range and
+ * doppler, without the guard window of 2 * guard + 1 bins in its centre. Windows are
+ * cut off at the edges of the map, except in doppler if the map holds all
+ * peri_symbols() doppler bins, which then wrap around. CA and GO take constant time
+ * per cell through summed-area tables of the map, OS has to sort the training cells.
+ *
+ * Each map produces a message on the detections port, a dictionary of "frame", the
+ * number of the map, and the vectors "range" and "doppler" in periodogram bins,
+ * "power" and "snr", the latter in dB, of the detected cells. Without zoom, doppler
+ * bins are integers from -roi_symbols() / 2, range bins from 0.
+ */
+class OFDMRADAR_API cfar_detector : virtual public gr::sync_block
+{
+public:
+    typedef std::shared_ptr<cfar_detector> sptr;
+
+    /*!
+     * \brief Return a shared_ptr to a new instance of ofdmradar::cfar_detector.
+     *
+     * To avoid accidental use of raw pointers, ofdmradar::cfar_detector's
+     * constructor is in a private implementation
+     * class. ofdmradar::cfar_detector::make is the public interface for
+     * creating new instances.
+     *
+     * \param ofdm_params   OFDM radar system parameters of the receiver
+     * \param mode          Noise level estimation
+     * \param guard_range   Guard cells on either side in range
+     * \param guard_doppler Guard cells on either side in doppler
+     * \param train_range   Training cells on either side in range, beyond the guard
+     * \param train_doppler Training cells on either side in doppler, beyond the guard
+     * \param threshold     Minimum SNR of a detection in dB
+     * \param rank          Order statistic of OS-CFAR, as a fraction of the training
+     *                      cells from 0 (the weakest) to 1 (the strongest)
+     * \param power_input   The input is the float power map of an integrating
+     *                      receiver instead of its complex periodogram
+     */
+    static sptr make(ofdmradar_params::sptr ofdm_params,
+                     cfar_mode mode,
+                     int guard_range,
+                     int guard_doppler,
+                     int train_range,
+                     int train_doppler,
+                     float threshold,
+                     float rank = 0.75f,
+                     bool power_input = false);
+};
+
+} // namespace ofdmradar
+} // namespace gr
+
+#endif /* INCLUDED_OFDMRADAR_CFAR_DETECTOR_H */
@@ -14,6 +14,18 @@
 namespace gr {
 namespace ofdmradar {
 
+/*!
+ * How much time is spent on planning the FFTs of the ofdmradar blocks. Corresponds
+ * to the FFTW_ESTIMATE, FFTW_MEASURE and FFTW_PATIENT planner flags.
+ */
+enum class OFDMRADAR_API fft_effort { ESTIMATE, MEASURE, PATIENT };
+
+/*!
+ * Sample format of a stream. FC32 are complex floats, SC16 interleaved 16 bit integer
+ * I/Q pairs as delivered by most SDR hardware, with 32768 as full scale.
+ */
+enum class OFDMRADAR_API sample_format { FC32, SC16 };
+
 /*!
  * \brief Common OFDM radar system parameters
  * \ingroup ofdmradar
@@ -40,9 +52,22 @@ private:
     unsigned int d_peri_carriers;
     unsigned int d_peri_symbols;
 
+    // Part of the periodogram that is output
+    unsigned int d_roi_carriers;
+    unsigned int d_roi_symbols;
+
+    // Output grid spacing and origin, in periodogram bins
+    float d_zoom;
+    float d_zoom_range;
+    float d_zoom_doppler;
+
     // FFT Window
     int d_window_type;
 
+    // FFT planning
+    fft_effort d_planning_effort;
+    std::string d_wisdom_file;
+
 public:
     /*!
      * Size of the main OFDM FFT. Note: Not all carriers will actually be in use
@@ -72,6 +97,49 @@ public:
      */
     unsigned int peri_length() const { return peri_carriers() * peri_symbols(); }
 
+    /*!
+     * How many range bins of the periodogram are output, starting at range zero
+     */
+    unsigned int roi_carriers() const { return d_roi_carriers; }
+
+    /*!
+     * How many doppler bins of the periodogram are output, centered around zero
+     * velocity. Rows are kept in FFT order: zero and positive velocities come first,
+     * followed by the negative ones.
+     */
+    unsigned int roi_symbols() const { return d_roi_symbols; }
+
+    /*!
+     * The total count of elements output per frame, roi_carriers() * roi_symbols()
+     */
+    unsigned int roi_length() const { return roi_carriers() * roi_symbols(); }
+
+    /*!
+     * Interpolation of the output grid relative to the periodogram. Output range and
+     * doppler bins are spaced 1 / zoom() periodogram bins apart.
+     */
+    float zoom() const { return d_zoom; }
+
+    /*!
+     * Range of the first output range bin, in periodogram range bins
+     */
+    float zoom_range() const { return d_zoom_range; }
+
+    /*!
+     * Doppler the output rows are centered around, in periodogram doppler bins. Rows
+     * keep the FFT order relative to it.
+     */
+    float zoom_doppler() const { return d_zoom_doppler; }
+
+    /*!
+     * Whether the output grid differs from the periodogram's, so the spectrum has to
+     * be evaluated by chirp-Z transforms instead of FFTs
+     */
+    bool zoomed() const
+    {
+        return d_zoom != 1.0f || d_zoom_range != 0.0f || d_zoom_doppler != 0.0f;
+    }
+
     /*!
      * Length of the cyclic prefix in samples. The cyclic prefix is the amount of
      * samples at the end of OFDM symbol that will be prepended at the front
@@ -141,6 +209,17 @@ public:
      */
     const std::vector<bool> &carrier_mask() const { return d_carrier_mask; }
 
+    /*!
+     * Planning effort for all FFTs of blocks using these parameters
+     */
+    fft_effort planning_effort() const { return d_planning_effort; }
+
+    /*!
+     * File FFTW wisdom is loaded from and saved to, so plans survive restarts. Empty
+     * if wisdom is not persisted.
+     */
+    const std::string &wisdom_file() const { return d_wisdom_file; }
+
     ofdmradar_params(unsigned int carriers,
                      unsigned int symbols,
                      unsigned int peri_carriers,
@@ -150,7 +229,14 @@ public:
                      unsigned int nyquist_guard,
                      int window_type,
                      std::vector<gr_complex> constellation,
-                     unsigned int seed);
+                     unsigned int seed,
+                     fft_effort planning_effort,
+                     const std::string &wisdom_file,
+                     unsigned int roi_carriers,
+                     unsigned int roi_symbols,
+                     float zoom,
+                     float zoom_range,
+                     float zoom_doppler);
 
     /*!
      * \brief Allocate new ofdm radar system parameters
@@ -166,6 +252,20 @@ public:
      * \param window_type The window type, see gr::fft::window
      * \param constellation A list of symbols comprising the constellation
      * \param seed      Random number generator seed
+     * \param planning_effort How thoroughly FFTW searches for fast transforms. Plans
+     *                  are cached process-wide, so each size is only planned once.
+     * \param wisdom_file FFTW wisdom file to load on the first plan and to update
+     *                  whenever a new transform was planned. Empty to disable.
+     * \param roi_carriers Range bins to output, 0 outputs all peri_carriers. Bins
+     *                  beyond the cyclic prefix carry no returns.
+     * \param roi_symbols Doppler bins to output around zero velocity, 0 outputs all
+     *                  peri_symbols
+     * \param zoom      Output bins per periodogram bin. Values other than 1 evaluate
+     *                  the region of interest densely with chirp-Z transforms, without
+     *                  growing the periodogram.
+     * \param zoom_range First output range bin, in periodogram range bins
+     * \param zoom_doppler Doppler the output is centered around, in periodogram
+     *                  doppler bins
      */
     static sptr make(unsigned int carriers,
                      unsigned int symbols,
@@ -176,7 +276,14 @@ public:
                      unsigned int nyquist_guard,
                      int window_type,
                      std::vector<gr_complex> constellation,
-                     unsigned int seed);
+                     unsigned int seed,
+                     fft_effort planning_effort = fft_effort::MEASURE,
+                     const std::string &wisdom_file = "",
+                     unsigned int roi_carriers = 0,
+                     unsigned int roi_symbols = 0,
+                     float zoom = 1.0f,
+                     float zoom_range = 0.0f,
+                     float zoom_doppler = 0.0f);
 
     std::string python_str() const;
 
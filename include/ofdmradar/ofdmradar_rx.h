@@ -19,6 +19,50 @@ namespace ofdmradar {
  * \brief OFDM Radar Receiver. Output is the periodogram
  * \ingroup ofdmradar
  *
+ * Every frame produces roi_symbols() rows of roi_carriers() range bins, see
+ * ofdmradar_params.
+ *
+ * With a hop, the receiver instead slides its coherent processing interval (CPI)
+ * over the symbol stream. Every hop symbols, it outputs the periodogram of the last
+ * symbols() symbols. Range processing is done once per symbol and reused by all
+ * CPIs the symbol is part of. CPIs spanning two receive buffers are only coherent
+ * if the frames are sent back to back, i.e. buffer_size equals the frame length.
+ *
+ * Receive buffers start with a packet length tag, if the source provides them. The
+ * tag's length then replaces buffer_size, which allows for gaps of any length
+ * between frames, or none at all. A buffer that starts early, e.g. because samples
+ * were lost in an overflow, makes the receiver resynchronise on it. Any partially
+ * received frame is dropped and counted by frames_dropped(). Tags of packets shorter
+ * than a frame are ignored.
+ *
+ * Without a fixed relationship between the RX and TX sample streams, the receiver
+ * can acquire the frame timing itself. It cross-correlates the received signal with
+ * the known TX frame once, then tracks the timing from the phase slope across the
+ * carriers of every frame's channel estimates. The strongest path, e.g. the direct TX
+ * to RX leakage, then ends up where a path without delay would, in range bin
+ * cyclic_prefix_length() / 2 * peri_carriers() / carriers(), as the FFT windows start
+ * half a cyclic prefix into the symbols.
+ *
+ * With integration, the receiver outputs the power |x|^2 of the periodograms as
+ * floats, averaged over several frames, and only one map per integration period.
+ *
+ * Static reflections and the TX to RX leakage can be suppressed before the doppler
+ * FFT. The receiver keeps a clutter map with the static background of every range bin,
+ * an exponential moving average over frames, and subtracts it from all symbols. The
+ * zero doppler notch instead subtracts the mean of the current frame, which removes
+ * everything at zero doppler.
+ *
+ * Several channels, e.g. the elements of an antenna array, can be received together.
+ * They share the frame timing, tags and acquisition of the first channel as well as
+ * the reference, windows and FFT plans, and are processed in parallel. Every output
+ * item then is a vector with the value of each channel, so a frame is a
+ * range-doppler-channel cube with the channel index running fastest.
+ *
+ * A transmitter cycling through a bank of several waveforms, see ofdmradar_tx, is
+ * received with the matching reference for every frame. The waveform of a buffer is
+ * taken from its "waveform" tag, if the length tag is accompanied by one. Otherwise
+ * buffers are counted, starting with the first waveform. Acquisition correlates
+ * with the first waveform, so its window grows with the number of waveforms.
  */
 class OFDMRADAR_API ofdmradar_rx : virtual public gr::block
 {
@@ -32,10 +76,56 @@ public:
      * constructor is in a private implementation
      * class. ofdmradar::ofdmradar_rx::make is the public interface for
      * creating new instances.
+     *
+     * \param ofdm_params OFDM radar system parameters
+     * \param len_tag_key Length tag key of the input stream, empty to only rely on
+     *                    buffer_size
+     * \param buffer_size Samples per received buffer, -1 for one frame
+     * \param nthreads    Threads used for range and doppler processing within a
+     *                    frame, 0 uses all available cores. The output does not
+     *                    depend on this setting.
+     * \param frame_buffers Number of periodogram buffers. With two or more, the doppler
+     *                    stage and output of a frame run on a separate thread while
+     *                    the next frame is already being received.
+     * \param hop         Symbols the CPI advances by between two outputs, up to
+     *                    symbols(). 0 outputs one periodogram per receive buffer.
+     *                    Requires a single frame buffer.
+     * \param acquire     Acquire and track the frame timing from the received
+     *                    signal instead of relying on receive buffers that start
+     *                    with a frame. Frames are expected every buffer_size samples,
+     *                    length tags are ignored.
+     * \param format      Input sample format. SC16 samples are converted while the
+     *                    symbols are loaded for the range FFT.
+     * \param integration Frames non-coherently integrated into every output power
+     *                    map, 0 outputs the complex periodogram of every frame
+     *                    instead
+     * \param exponential Integrate with an exponential moving average with a time
+     *                    constant of integration frames instead of a block average
+     * \param clutter_alpha Weight of every new frame in the clutter map, between 0
+     *                    and 1. 0 disables the clutter map.
+     * \param notch       Subtract the mean of every frame, i.e. its zero doppler bin
+     * \param channels    Number of input streams received in lockstep
+     * \param waveforms   Number of frames in the waveform bank of the transmitter
      */
     static sptr make(ofdmradar_params::sptr ofdm_params,
                      const std::string &len_tag_key,
-                     size_t buffer_size);
+                     size_t buffer_size,
+                     int nthreads = 1,
+                     int frame_buffers = 1,
+                     int hop = 0,
+                     bool acquire = false,
+                     sample_format format = sample_format::FC32,
+                     int integration = 0,
+                     bool exponential = false,
+                     float clutter_alpha = 0,
+                     bool notch = false,
+                     int channels = 1,
+                     int waveforms = 1);
+
+    /*!
+     * Number of partially received frames dropped to resynchronise on a length tag
+     */
+    virtual uint64_t frames_dropped() const = 0;
 };
 
 } // namespace ofdmradar
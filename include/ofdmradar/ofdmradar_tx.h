@@ -21,6 +21,22 @@ namespace ofdmradar {
  *
  *  This block is responsible for the generation of the OFDM frame
  *
+ * It can cycle through a bank of several distinct frames, so ambiguities do not add up
+ * coherently from frame to frame and non-coherently integrated frames are
+ * independent. Frame f of the bank is drawn with the frame counter f of the symbol
+ * generator, frame 0 is the one a single waveform repeats. With more than one
+ * waveform, every frame start is tagged with the frame's index in the bank under the
+ * key "waveform", which lets ofdmradar_rx select the matching reference.
+ *
+ * For bursty transmission, e.g. under TDD control, frames can be followed by an idle
+ * gap of zeros, which the length tags include. Alternatively every frame is output as
+ * a burst, tagged with tx_sob on its first and tx_eob on its last sample, and the gap
+ * is not output at all but left to the sink.
+ *
+ * The frames can be output as SC16 samples to feed the DAC directly. They are
+ * converted once at startup, scaled so that the largest I or Q component of all
+ * frames is backoff dB below full scale. Negative back-offs drive the frames into
+ * clipping, which is counted by clipped_samples().
  */
 class OFDMRADAR_API ofdmradar_tx : virtual public gr::sync_block
 {
@@ -37,8 +53,31 @@ public:
      *
      * \param ofdm_params OFDM radar system parameters
      * \param len_tag_key Output data will be length-tagged with this key.
+     * \param waveforms   Number of frames in the waveform bank
+     * \param gap         Idle samples after every frame, ignored with burst tags
+     * \param burst_tags  Tag every frame as a burst instead of outputting the gap
+     * \param format      Output sample format
+     * \param backoff     Headroom of SC16 output in dB, relative to the peak of the
+     *                    frames
+     */
+    static sptr make(ofdmradar_params::sptr ofdm_params,
+                     const std::string &len_tag_key,
+                     int waveforms = 1,
+                     int gap = 0,
+                     bool burst_tags = false,
+                     sample_format format = sample_format::FC32,
+                     float backoff = 0);
+
+    /*!
+     * Peak to average power ratio of the frames in dB
+     */
+    virtual float papr() const = 0;
+
+    /*!
+     * Number of samples of the frames with an I or Q component clipped in the
+     * conversion to SC16
      */
-    static sptr make(ofdmradar_params::sptr ofdm_params, const std::string &len_tag_key);
+    virtual uint64_t clipped_samples() const = 0;
 };
 
 } // namespace ofdmradar
@@ -0,0 +1,76 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2021 Analog Devices, Inc.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef INCLUDED_OFDMRADAR_PEAK_EXTRACTOR_H
+#define INCLUDED_OFDMRADAR_PEAK_EXTRACTOR_H
+
+#include <gnuradio/sync_block.h>
+#include <ofdmradar/api.h>
+#include <ofdmradar/ofdmradar.h>
+
+namespace gr {
+namespace ofdmradar {
+
+/*!
+ * How the position of a peak is refined between bins. PARABOLIC fits a parabola to
+ * the log power of the peak and its neighbours. SINC searches the maximum of the
+ * complex periodogram, interpolated with the periodic sinc kernel of the zero padded
+ * FFTs.
+ */
+enum class OFDMRADAR_API peak_interpolation { PARABOLIC, SINC };
+
+/*!
+ * \brief Extracts the strongest peaks of the range-doppler maps output by
+ *        ofdmradar_rx
+ * \ingroup ofdmradar
+ *
+ * Peaks are cells above the threshold which are not weaker than any of their eight
+ * neighbours. Their position is refined in range and doppler separately and
+ * converted to physical units: the range in m, corrected by the half cyclic prefix
+ * the receiver starts its FFT windows early, and the radial velocity in m/s,
+ * positive towards the radar.
+ *
+ * Each map produces a message on the peaks port, a dictionary of "frame", the number
+ * of the map, and the vectors "range", "velocity", "range_bin" and "doppler_bin" in
+ * periodogram bins and "power" of the peaks, strongest first.
+ */
+class OFDMRADAR_API peak_extractor : virtual public gr::sync_block
+{
+public:
+    typedef std::shared_ptr<peak_extractor> sptr;
+
+    /*!
+     * \brief Return a shared_ptr to a new instance of ofdmradar::peak_extractor.
+     *
+     * To avoid accidental use of raw pointers, ofdmradar::peak_extractor's
+     * constructor is in a private implementation
+     * class. ofdmradar::peak_extractor::make is the public interface for
+     * creating new instances.
+     *
+     * \param ofdm_params   OFDM radar system parameters of the receiver
+     * \param max_peaks     Maximum number of peaks per map
+     * \param threshold     Minimum power of a peak in dB
+     * \param interpolation Refinement of the peak positions. SINC requires the
+     *                      complex periodogram.
+     * \param sample_rate   Sample rate in Hz
+     * \param carrier_freq  Carrier frequency in Hz
+     * \param power_input   The input is the float power map of an integrating
+     *                      receiver instead of its complex periodogram
+     */
+    static sptr make(ofdmradar_params::sptr ofdm_params,
+                     int max_peaks,
+                     float threshold,
+                     peak_interpolation interpolation,
+                     double sample_rate,
+                     double carrier_freq,
+                     bool power_input = false);
+};
+
+} // namespace ofdmradar
+} // namespace gr
+
+#endif /* INCLUDED_OFDMRADAR_PEAK_EXTRACTOR_H */
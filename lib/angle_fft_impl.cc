@@ -0,0 +1,194 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2021 Analog Devices, Inc.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "angle_fft_impl.h"
+
+#include <gnuradio/io_signature.h>
+#include <volk/volk.h>
+#include <boost/format.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace gr {
+namespace ofdmradar {
+
+namespace {
+
+// Cells transformed together. Large enough to amortise the plan execution, small
+// enough for the buffers of a worker to stay in L1/L2 for common sizes.
+constexpr unsigned int angle_batch_cells = 64;
+
+} // namespace
+
+angle_fft::sptr angle_fft::make(ofdmradar_params::sptr ofdm_params,
+                                int array_size,
+                                int angle_bins,
+                                bool max_projection,
+                                int nthreads)
+{
+    return gnuradio::make_block_sptr<angle_fft_impl>(
+        ofdm_params, array_size, angle_bins, max_projection, nthreads);
+}
+
+angle_fft_impl::angle_fft_impl(ofdmradar_params::sptr ofdm_params,
+                               int array_size,
+                               int angle_bins,
+                               bool max_projection,
+                               int nthreads)
+    : gr::sync_block("angle_fft",
+                     gr::io_signature::make(
+                         1, 1, std::max(array_size, 1) * sizeof(gr_complex)),
+                     max_projection
+                         ? gr::io_signature::make(1, 2, sizeof(float))
+                         : gr::io_signature::make(
+                               1, 1, std::max(angle_bins, 1) * sizeof(float))),
+      d_array_size(array_size),
+      d_angle_bins(angle_bins),
+      d_max_projection(max_projection),
+      d_calib_port_id(pmt::intern("calib")),
+      d_weights(std::max(array_size, 1), 1.0f),
+      d_workers(worker_pool::thread_count(nthreads))
+{
+    if (array_size < 1 || angle_bins < array_size)
+        throw std::runtime_error(
+            boost::str(boost::format("angle_fft: Angle bins (%d) must be at least the "
+                                     "array size (%d), which must be positive!") %
+                       angle_bins % array_size));
+
+    for (unsigned int i = 0; i < d_workers.size(); i++) {
+        d_inputs.emplace_back(angle_batch_cells * angle_bins, 0.0f);
+        d_spectra.emplace_back(angle_batch_cells * angle_bins);
+        if (max_projection)
+            d_power.emplace_back(angle_batch_cells * angle_bins);
+    }
+
+    d_fft = std::make_unique<batched_fft>(angle_bins,
+                                          angle_batch_cells,
+                                          1,
+                                          angle_bins,
+                                          FFTW_FORWARD,
+                                          d_inputs[0].data(),
+                                          d_spectra[0].data(),
+                                          *ofdm_params);
+
+    message_port_register_in(d_calib_port_id);
+    set_msg_handler(d_calib_port_id, [this](pmt::pmt_t msg) { handle_calib(msg); });
+}
+
+angle_fft_impl::~angle_fft_impl() {}
+
+void angle_fft_impl::handle_calib(pmt::pmt_t msg)
+{
+    if (!pmt::is_blob(msg)) {
+        GR_LOG_WARN(d_logger, "Received invalid message on calib message port!");
+        return;
+    }
+
+    const size_t expected = sizeof(gr_complex) * d_array_size;
+    if (pmt::blob_length(msg) != expected) {
+        GR_LOG_WARN(d_logger,
+                    boost::format("Calibration blob: Expected %lu bytes, got %lu.") %
+                        expected % pmt::blob_length(msg));
+        return;
+    }
+
+    // Only the phases are corrected, the gains would change the noise level of the
+    // elements relative to each other
+    const gr_complex *gains = reinterpret_cast<const gr_complex *>(pmt::blob_data(msg));
+    std::lock_guard<std::mutex> lock(d_calib_mutex);
+    d_pending_weights.resize(d_array_size);
+    for (int i = 0; i < d_array_size; i++) {
+        const float magnitude = std::abs(gains[i]);
+        d_pending_weights[i] = magnitude > 0 ? std::conj(gains[i]) / magnitude : 1.0f;
+    }
+    d_weights_changed = true;
+}
+
+void angle_fft_impl::process_batch(const gr_complex *in,
+                                   unsigned int count,
+                                   float *out,
+                                   float *angle,
+                                   unsigned int worker)
+{
+    const unsigned int k = d_array_size;
+    const unsigned int a = d_angle_bins;
+    const float scale = 1.0f / k;
+    gr_complex *inputs = d_inputs[worker].data();
+    gr_complex *spectra = d_spectra[worker].data();
+
+    // Cells beyond count keep stale inputs, their spectra are ignored
+    for (unsigned int i = 0; i < count; i++)
+        volk_32fc_x2_multiply_32fc(&inputs[i * a], &in[i * k], d_weights.data(), k);
+
+    d_fft->execute(inputs, spectra);
+
+    if (!d_max_projection) {
+        // Sort the bins from FFT order into ascending angle
+        const unsigned int negative = a / 2;
+        for (unsigned int i = 0; i < count; i++) {
+            const gr_complex *spectrum = &spectra[i * a];
+            float *bins = &out[i * a];
+            volk_32fc_magnitude_squared_32f(bins, &spectrum[a - negative], negative);
+            volk_32fc_magnitude_squared_32f(&bins[negative], spectrum, a - negative);
+        }
+        volk_32f_s32f_multiply_32f(out, out, scale, count * a);
+        return;
+    }
+
+    float *power = d_power[worker].data();
+    volk_32fc_magnitude_squared_32f(power, spectra, count * a);
+    for (unsigned int i = 0; i < count; i++) {
+        uint32_t bin = 0;
+        volk_32f_index_max_32u(&bin, &power[i * a], a);
+        out[i] = power[i * a + bin] * scale;
+
+        if (angle) {
+            const int signed_bin = bin < (a + 1) / 2 ? int(bin) : int(bin) - int(a);
+            angle[i] = std::asin(std::min(1.0f, 2.0f * signed_bin / a));
+        }
+    }
+}
+
+int angle_fft_impl::work(int noutput_items,
+                         gr_vector_const_void_star &input_items,
+                         gr_vector_void_star &output_items)
+{
+    const gr_complex *in = static_cast<const gr_complex *>(input_items[0]);
+    float *out = static_cast<float *>(output_items[0]);
+    float *angle =
+        output_items.size() > 1 ? static_cast<float *>(output_items[1]) : nullptr;
+    const unsigned int out_size = d_max_projection ? 1 : d_angle_bins;
+
+    {
+        std::lock_guard<std::mutex> lock(d_calib_mutex);
+        if (d_weights_changed) {
+            std::copy(
+                d_pending_weights.begin(), d_pending_weights.end(), d_weights.begin());
+            d_weights_changed = false;
+        }
+    }
+
+    const unsigned int batches =
+        (noutput_items + angle_batch_cells - 1) / angle_batch_cells;
+    d_workers.run(batches, [&](unsigned int job, unsigned int worker) {
+        const unsigned int first = job * angle_batch_cells;
+        const unsigned int count =
+            std::min<unsigned int>(angle_batch_cells, noutput_items - first);
+        process_batch(&in[first * d_array_size],
+                      count,
+                      &out[first * out_size],
+                      angle ? &angle[first] : nullptr,
+                      worker);
+    });
+
+    return noutput_items;
+}
+
+} /* namespace ofdmradar */
+} /* namespace gr */
@@ -0,0 +1,77 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2021 Analog Devices, Inc.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef INCLUDED_OFDMRADAR_ANGLE_FFT_IMPL_H
+#define INCLUDED_OFDMRADAR_ANGLE_FFT_IMPL_H
+
+#include "batched_fft.h"
+#include "worker_pool.h"
+
+#include <ofdmradar/angle_fft.h>
+
+#include <pmt/pmt.h>
+#include <volk/volk_alloc.hh>
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace gr {
+namespace ofdmradar {
+
+class angle_fft_impl : public angle_fft
+{
+private:
+    int d_array_size;
+    int d_angle_bins;
+    bool d_max_projection;
+    pmt::pmt_t d_calib_port_id;
+
+    // Calibration weights, the conjugate phase of every element's gain. The message
+    // handler leaves new ones in d_pending_weights for work() to pick up.
+    volk::vector<gr_complex> d_weights;
+    std::vector<gr_complex> d_pending_weights;
+    bool d_weights_changed = false;
+    std::mutex d_calib_mutex;
+
+    // Every worker transforms batches of cells from its own zero padded input buffer,
+    // whose padding is never overwritten, to its spectrum buffer
+    std::unique_ptr<batched_fft> d_fft;
+    worker_pool d_workers;
+    std::vector<volk::vector<gr_complex>> d_inputs;
+    std::vector<volk::vector<gr_complex>> d_spectra;
+    std::vector<volk::vector<float>> d_power;
+
+    void handle_calib(pmt::pmt_t msg);
+
+    /*!
+     * Beamforms count cells of in to out, and with the max projection the angles of
+     * the maxima to angle unless it is nullptr
+     */
+    void process_batch(const gr_complex *in,
+                       unsigned int count,
+                       float *out,
+                       float *angle,
+                       unsigned int worker);
+
+public:
+    angle_fft_impl(ofdmradar_params::sptr ofdm_params,
+                   int array_size,
+                   int angle_bins,
+                   bool max_projection,
+                   int nthreads);
+    ~angle_fft_impl();
+
+    int work(int noutput_items,
+             gr_vector_const_void_star &input_items,
+             gr_vector_void_star &output_items);
+};
+
+} // namespace ofdmradar
+} // namespace gr
+
+#endif /* INCLUDED_OFDMRADAR_ANGLE_FFT_IMPL_H */
@@ -0,0 +1,202 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2021 Analog Devices, Inc.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "batched_fft.h"
+
+#include <gnuradio/fft/fft.h>
+
+#include <boost/format.hpp>
+
+#include <map>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <tuple>
+
+namespace gr {
+namespace ofdmradar {
+
+namespace {
+
+unsigned int planner_flags(fft_effort effort)
+{
+    switch (effort) {
+    case fft_effort::ESTIMATE:
+        return FFTW_ESTIMATE;
+    case fft_effort::PATIENT:
+        return FFTW_PATIENT;
+    case fft_effort::MEASURE:
+    default:
+        return FFTW_MEASURE;
+    }
+}
+
+struct fftwf_deleter {
+    void operator()(void *p) const { fftwf_free(p); }
+};
+
+/*!
+ * Plans of all ofdmradar blocks, keyed by their layout and planner flags. FFTW's
+ * planner is not thread-safe, so all access is serialised with the mutex the GNU
+ * Radio FFT blocks use for planning as well.
+ */
+class plan_cache
+{
+private:
+    // size, howmany, stride, in_dist, out_dist, sign, in place, in/out alignment, flags
+    typedef std::tuple<int, int, int, int, int, int, bool, int, int, unsigned int> key_t;
+
+    std::map<key_t, fftwf_plan> d_plans;
+    std::set<std::string> d_loaded_wisdom;
+
+    // Element count spanned by a batch
+    static size_t extent(int size, int howmany, int stride, int dist)
+    {
+        return size_t(howmany - 1) * dist + size_t(size - 1) * stride + 1;
+    }
+
+public:
+    ~plan_cache()
+    {
+        for (auto &p : d_plans)
+            fftwf_destroy_plan(p.second);
+    }
+
+    fftwf_plan get(int size,
+                   int howmany,
+                   int stride,
+                   int in_dist,
+                   int out_dist,
+                   int sign,
+                   bool in_place,
+                   int in_alignment,
+                   int out_alignment,
+                   const ofdmradar_params &params)
+    {
+        const unsigned int flags = planner_flags(params.planning_effort());
+        const key_t key(size,
+                        howmany,
+                        stride,
+                        in_dist,
+                        out_dist,
+                        sign,
+                        in_place,
+                        in_alignment,
+                        out_alignment,
+                        flags);
+        const std::string &wisdom = params.wisdom_file();
+
+        gr::thread::scoped_lock lock(gr::fft::planner::mutex());
+
+        auto it = d_plans.find(key);
+        if (it != d_plans.end())
+            return it->second;
+
+        if (!wisdom.empty() && d_loaded_wisdom.insert(wisdom).second)
+            fftwf_import_wisdom_from_filename(wisdom.c_str()); // May not exist yet
+
+        // Scratch buffers offset by the same number of bytes as the real ones
+        const size_t in_size = extent(size, howmany, stride, in_dist);
+        const size_t out_size = extent(size, howmany, stride, out_dist);
+        std::unique_ptr<char, fftwf_deleter> in_buffer(static_cast<char *>(
+            fftwf_malloc(in_size * sizeof(gr_complex) + in_alignment)));
+        std::unique_ptr<char, fftwf_deleter> out_buffer(
+            in_place ? nullptr
+                     : static_cast<char *>(
+                           fftwf_malloc(out_size * sizeof(gr_complex) + out_alignment)));
+        if (!in_buffer || (!in_place && !out_buffer))
+            throw std::runtime_error("batched_fft: Failed to allocate planning buffers!");
+
+        auto in = reinterpret_cast<fftwf_complex *>(in_buffer.get() + in_alignment);
+        auto out = in_place ? in
+                            : reinterpret_cast<fftwf_complex *>(out_buffer.get() +
+                                                                 out_alignment);
+
+        fftwf_plan plan = fftwf_plan_many_dft(1,
+                                              &size,
+                                              howmany,
+                                              in,
+                                              nullptr,
+                                              stride,
+                                              in_dist,
+                                              out,
+                                              nullptr,
+                                              stride,
+                                              out_dist,
+                                              sign,
+                                              flags);
+        if (!plan)
+            throw std::runtime_error(
+                boost::str(boost::format("batched_fft: Failed to plan %d transforms of "
+                                         "size %d!") %
+                           howmany % size));
+
+        if (!wisdom.empty())
+            fftwf_export_wisdom_to_filename(wisdom.c_str());
+
+        d_plans.emplace(key, plan);
+        return plan;
+    }
+};
+
+plan_cache &plans()
+{
+    static plan_cache cache;
+    return cache;
+}
+
+} // namespace
+
+int batched_fft::fast_size(int minimum)
+{
+    for (int size = minimum;; size++) {
+        int rest = size;
+        for (int factor : { 2, 3, 5 })
+            while (rest % factor == 0)
+                rest /= factor;
+        if (rest == 1)
+            return size;
+    }
+}
+
+batched_fft::batched_fft(int size,
+                         int howmany,
+                         int stride,
+                         int dist,
+                         int sign,
+                         const gr_complex *in,
+                         const gr_complex *out,
+                         const ofdmradar_params &params)
+    : batched_fft(size, howmany, stride, dist, dist, sign, in, out, params)
+{
+}
+
+batched_fft::batched_fft(int size,
+                         int howmany,
+                         int stride,
+                         int in_dist,
+                         int out_dist,
+                         int sign,
+                         const gr_complex *in,
+                         const gr_complex *out,
+                         const ofdmradar_params &params)
+    : d_in_alignment(alignment_of(in)), d_out_alignment(alignment_of(out))
+{
+    d_plan = plans().get(size,
+                         howmany,
+                         stride,
+                         in_dist,
+                         out_dist,
+                         sign,
+                         in == out,
+                         d_in_alignment,
+                         d_out_alignment,
+                         params);
+}
+
+} /* namespace ofdmradar */
+} /* namespace gr */
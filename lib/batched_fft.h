@@ -0,0 +1,122 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2021 Analog Devices, Inc.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef INCLUDED_OFDMRADAR_BATCHED_FFT_H
+#define INCLUDED_OFDMRADAR_BATCHED_FFT_H
+
+#include <gnuradio/gr_complex.h>
+#include <ofdmradar/ofdmradar.h>
+
+#include <fftw3.h>
+
+namespace gr {
+namespace ofdmradar {
+
+/*!
+ * \brief A batch of equally sized one dimensional transforms, planned as a single
+ *        fftwf_plan_many_dft.
+ *
+ * Transform i reads its k-th element from in[i * dist + k * stride], so the same
+ * engine can run along rows (stride = 1, dist = row length) as well as along columns
+ * (stride = row length, dist = 1) of a row major matrix.
+ *
+ * Plans come from a process-wide cache shared by all blocks, so every layout is only
+ * planned once per process. Plans are never destroyed before the process exits.
+ */
+class batched_fft
+{
+private:
+    fftwf_plan d_plan;
+    int d_in_alignment;
+    int d_out_alignment;
+
+    static int alignment_of(const gr_complex *p)
+    {
+        return fftwf_alignment_of(
+            reinterpret_cast<float *>(const_cast<gr_complex *>(p)));
+    }
+
+public:
+    /*!
+     * Looks up or plans a transform for buffers like the given ones. Planning runs on
+     * scratch buffers of the same alignment, so in and out are left untouched.
+     *
+     * \param size    Length of each transform
+     * \param howmany Number of transforms in the batch
+     * \param stride  Distance between two consecutive elements of one transform
+     * \param dist    Distance between the first elements of two consecutive transforms
+     * \param sign    FFTW_FORWARD or FFTW_BACKWARD
+     * \param in      Input buffer used for planning
+     * \param out     Output buffer used for planning, may be equal to in
+     * \param params  Supplies the planning effort and the wisdom file
+     */
+    batched_fft(int size,
+                int howmany,
+                int stride,
+                int dist,
+                int sign,
+                const gr_complex *in,
+                const gr_complex *out,
+                const ofdmradar_params &params);
+
+    /*!
+     * Like above, but input and output transforms are packed differently, e.g. to
+     * read symbols with their cyclic prefix in between straight from a stream.
+     */
+    batched_fft(int size,
+                int howmany,
+                int stride,
+                int in_dist,
+                int out_dist,
+                int sign,
+                const gr_complex *in,
+                const gr_complex *out,
+                const ofdmradar_params &params);
+
+    /*!
+     * First transform size of at least minimum elements that only has the prime
+     * factors 2, 3 and 5, which FFTW transforms fastest
+     */
+    static int fast_size(int minimum);
+
+    batched_fft(const batched_fft &) = delete;
+    batched_fft &operator=(const batched_fft &) = delete;
+
+    /*!
+     * Whether execute() may be called on these buffers, i.e. whether their SIMD
+     * alignment matches the one of the planning buffers
+     */
+    bool can_execute(const gr_complex *in, const gr_complex *out) const
+    {
+        return alignment_of(in) == d_in_alignment && alignment_of(out) == d_out_alignment;
+    }
+
+    /*!
+     * Runs the transform on a different pair of buffers. Both have to share the
+     * alignment of the planning buffers and in-place-ness has to match the plan.
+     */
+    void execute(gr_complex *in, gr_complex *out) const
+    {
+        fftwf_execute_dft(d_plan,
+                          reinterpret_cast<fftwf_complex *>(in),
+                          reinterpret_cast<fftwf_complex *>(out));
+    }
+
+    /*!
+     * Out-of-place transform of a read-only buffer. FFTW preserves the input of
+     * out-of-place complex transforms.
+     */
+    void execute(const gr_complex *in, gr_complex *out) const
+    {
+        execute(const_cast<gr_complex *>(in), out);
+    }
+};
+
+} // namespace ofdmradar
+} // namespace gr
+
+#endif /* INCLUDED_OFDMRADAR_BATCHED_FFT_H */
@@ -0,0 +1,269 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2021 Analog Devices, Inc.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "cfar_detector_impl.h"
+#include "doppler_rows.h"
+
+#include <gnuradio/io_signature.h>
+#include <boost/format.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace gr {
+namespace ofdmradar {
+
+cfar_detector::sptr cfar_detector::make(ofdmradar_params::sptr ofdm_params,
+                                        cfar_mode mode,
+                                        int guard_range,
+                                        int guard_doppler,
+                                        int train_range,
+                                        int train_doppler,
+                                        float threshold,
+                                        float rank,
+                                        bool power_input)
+{
+    return gnuradio::make_block_sptr<cfar_detector_impl>(ofdm_params,
+                                                         mode,
+                                                         guard_range,
+                                                         guard_doppler,
+                                                         train_range,
+                                                         train_doppler,
+                                                         threshold,
+                                                         rank,
+                                                         power_input);
+}
+
+cfar_detector_impl::cfar_detector_impl(ofdmradar_params::sptr ofdm_params,
+                                       cfar_mode mode,
+                                       int guard_range,
+                                       int guard_doppler,
+                                       int train_range,
+                                       int train_doppler,
+                                       float threshold,
+                                       float rank,
+                                       bool power_input)
+    : gr::sync_block("cfar_detector",
+                     gr::io_signature::make(
+                         1, 1, power_input ? sizeof(float) : sizeof(gr_complex)),
+                     gr::io_signature::make(0, 0, 0)),
+      d_ofdm_params(ofdm_params),
+      d_mode(mode),
+      d_guard_range(guard_range),
+      d_guard_doppler(guard_doppler),
+      d_train_range(train_range),
+      d_train_doppler(train_doppler),
+      d_threshold(std::pow(10.0f, threshold / 10)),
+      d_rank(rank),
+      d_power_input(power_input),
+      d_detections_port_id(pmt::intern("detections")),
+      d_rows(ofdm_params->roi_symbols()),
+      d_cols(ofdm_params->roi_carriers()),
+      d_pad(guard_doppler + train_doppler),
+      d_wrap(doppler_wraps(*ofdm_params))
+{
+    if (guard_range < 0 || guard_doppler < 0 || train_range < 0 || train_doppler < 0 ||
+        train_range + train_doppler == 0)
+        throw std::runtime_error(boost::str(
+            boost::format("cfar_detector: Invalid window of %d/%d guard and %d/%d "
+                          "training cells in range/doppler!") %
+            guard_range % guard_doppler % train_range % train_doppler));
+
+    // A wrapped around window must not hold a row twice
+    if (d_wrap && 2 * d_pad + 1 > d_rows)
+        throw std::runtime_error(
+            boost::str(boost::format("cfar_detector: Doppler window (%d) exceeds the "
+                                     "%d doppler bins!") %
+                       (2 * d_pad + 1) % d_rows));
+
+    if (rank < 0 || rank > 1)
+        throw std::runtime_error(boost::str(
+            boost::format("cfar_detector: Rank (%g) must be between 0 and 1!") % rank));
+
+    d_power.resize((d_rows + 2 * d_pad) * d_cols);
+    d_sums.resize((d_rows + 2 * d_pad + 1) * (d_cols + 1));
+
+    this->set_output_multiple(ofdm_params->roi_length());
+    message_port_register_out(d_detections_port_id);
+}
+
+cfar_detector_impl::~cfar_detector_impl() {}
+
+double cfar_detector_impl::sum(int r0, int r1, int c0, int c1) const
+{
+    if (r0 > r1 || c0 > c1)
+        return 0;
+
+    const int w = d_cols + 1;
+    return d_sums[(r1 + 1) * w + c1 + 1] - d_sums[r0 * w + c1 + 1] -
+           d_sums[(r1 + 1) * w + c0] + d_sums[r0 * w + c0];
+}
+
+int cfar_detector_impl::count(int r0, int r1, int c0, int c1) const
+{
+    if (!d_wrap) {
+        r0 = std::max(r0, d_pad);
+        r1 = std::min(r1, d_pad + d_rows - 1);
+    }
+
+    return std::max(0, r1 - r0 + 1) * std::max(0, c1 - c0 + 1);
+}
+
+float cfar_detector_impl::noise(int row, int col)
+{
+    // Outer and guard window, rows in the padded map
+    const int r0 = row - d_guard_doppler - d_train_doppler;
+    const int r1 = row + d_guard_doppler + d_train_doppler;
+    const int c0 = std::max(0, col - d_guard_range - d_train_range);
+    const int c1 = std::min(d_cols - 1, col + d_guard_range + d_train_range);
+    const int g_r0 = row - d_guard_doppler;
+    const int g_r1 = row + d_guard_doppler;
+    const int g_c0 = std::max(0, col - d_guard_range);
+    const int g_c1 = std::min(d_cols - 1, col + d_guard_range);
+
+    // Mean of the training cells within columns [b0, b1] and guard columns [h0, h1],
+    // -1 if there are none. Rounding can leave a slightly negative difference of the
+    // sums of a noise free map.
+    const auto mean = [&](int b0, int b1, int h0, int h1) {
+        const int n = count(r0, r1, b0, b1) - count(g_r0, g_r1, h0, h1);
+        if (n <= 0)
+            return -1.0;
+        return std::max(0.0, (sum(r0, r1, b0, b1) - sum(g_r0, g_r1, h0, h1)) / n);
+    };
+
+    double level = -1;
+    switch (d_mode) {
+    case cfar_mode::CA:
+        level = mean(c0, c1, g_c0, g_c1);
+        break;
+
+    case cfar_mode::GO:
+        // Both halves hold the training cells of the cell's own range bin, so a window
+        // without any range training cells still has a level
+        level = std::max(mean(c0, col, g_c0, col), mean(col, c1, col, g_c1));
+        break;
+
+    case cfar_mode::OS: {
+        d_training.clear();
+        for (int r = r0; r <= r1; r++) {
+            if (!d_wrap && (r < d_pad || r >= d_pad + d_rows))
+                continue;
+
+            const float *p = &d_power[r * d_cols];
+            for (int c = c0; c <= c1; c++)
+                if (r < g_r0 || r > g_r1 || c < g_c0 || c > g_c1)
+                    d_training.push_back(p[c]);
+        }
+
+        if (d_training.empty())
+            break;
+
+        auto nth = d_training.begin() + int(d_rank * (d_training.size() - 1) + 0.5f);
+        std::nth_element(d_training.begin(), nth, d_training.end());
+        level = *nth;
+        break;
+    }
+    }
+
+    // Nothing is detected without any training cells
+    if (level < 0)
+        return std::numeric_limits<float>::infinity();
+    return std::max(level, double(std::numeric_limits<float>::min()));
+}
+
+void cfar_detector_impl::load_map(const void *in)
+{
+    load_doppler_rows(in, d_power_input, d_rows, d_cols, &d_power[d_pad * d_cols]);
+
+    if (d_wrap) {
+        std::memcpy(d_power.data(),
+                    &d_power[d_rows * d_cols],
+                    sizeof(float) * d_pad * d_cols);
+        std::memcpy(&d_power[(d_pad + d_rows) * d_cols],
+                    &d_power[d_pad * d_cols],
+                    sizeof(float) * d_pad * d_cols);
+    }
+
+    const int w = d_cols + 1;
+    for (int i = 0; i < d_rows + 2 * d_pad; i++) {
+        const float *p = &d_power[i * d_cols];
+        const double *above = &d_sums[i * w];
+        double *s = &d_sums[(i + 1) * w];
+        double row = 0;
+        for (int j = 0; j < d_cols; j++) {
+            row += p[j];
+            s[j + 1] = above[j + 1] + row;
+        }
+    }
+}
+
+void cfar_detector_impl::detect()
+{
+    const float zoom = d_ofdm_params->zoom();
+
+    d_range.clear();
+    d_doppler.clear();
+    d_detected_power.clear();
+    d_snr.clear();
+
+    for (int i = 0; i < d_rows; i++) {
+        const int row = d_pad + i;
+        const float *p = &d_power[row * d_cols];
+        for (int col = 0; col < d_cols; col++) {
+            if (!(p[col] > 0))
+                continue;
+
+            const float level = noise(row, col);
+            if (p[col] <= d_threshold * level)
+                continue;
+
+            d_range.push_back(d_ofdm_params->zoom_range() + col / zoom);
+            d_doppler.push_back(d_ofdm_params->zoom_doppler() +
+                                (i - d_rows / 2) / zoom);
+            d_detected_power.push_back(p[col]);
+            d_snr.push_back(10 * std::log10(p[col] / level));
+        }
+    }
+}
+
+int cfar_detector_impl::work(int noutput_items,
+                             gr_vector_const_void_star &input_items,
+                             gr_vector_void_star &output_items)
+{
+    const auto roi_length = d_ofdm_params->roi_length();
+    const size_t item_size = d_power_input ? sizeof(float) : sizeof(gr_complex);
+    const char *in = static_cast<const char *>(input_items[0]);
+
+    for (int i = 0; i + int(roi_length) <= noutput_items; i += roi_length) {
+        load_map(&in[i * item_size]);
+        detect();
+
+        pmt::pmt_t msg = pmt::make_dict();
+        msg = pmt::dict_add(msg, pmt::intern("frame"), pmt::from_uint64(d_frame++));
+        msg = pmt::dict_add(msg,
+                            pmt::intern("range"),
+                            pmt::init_f32vector(d_range.size(), d_range));
+        msg = pmt::dict_add(msg,
+                            pmt::intern("doppler"),
+                            pmt::init_f32vector(d_doppler.size(), d_doppler));
+        msg = pmt::dict_add(
+            msg,
+            pmt::intern("power"),
+            pmt::init_f32vector(d_detected_power.size(), d_detected_power));
+        msg = pmt::dict_add(
+            msg, pmt::intern("snr"), pmt::init_f32vector(d_snr.size(), d_snr));
+        message_port_pub(d_detections_port_id, msg);
+    }
+
+    return noutput_items - noutput_items % roi_length;
+}
+
+} /* namespace ofdmradar */
+} /* namespace gr */
@@ -0,0 +1,88 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2021 Analog Devices, Inc.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef INCLUDED_OFDMRADAR_CFAR_DETECTOR_IMPL_H
+#define INCLUDED_OFDMRADAR_CFAR_DETECTOR_IMPL_H
+
+#include <ofdmradar/cfar_detector.h>
+
+#include <pmt/pmt.h>
+#include <volk/volk_alloc.hh>
+
+#include <vector>
+
+namespace gr {
+namespace ofdmradar {
+
+class cfar_detector_impl : public cfar_detector
+{
+private:
+    ofdmradar_params::sptr d_ofdm_params;
+    cfar_mode d_mode;
+    int d_guard_range;
+    int d_guard_doppler;
+    int d_train_range;
+    int d_train_doppler;
+    float d_threshold; // Linear power ratio
+    float d_rank;
+    bool d_power_input;
+    pmt::pmt_t d_detections_port_id;
+    uint64_t d_frame = 0;
+
+    // Map dimensions. Rows are sorted by doppler, from negative to positive, and
+    // padded with d_pad rows on either side, which hold the wrapped around rows if
+    // d_wrap is set and zeros otherwise.
+    int d_rows;
+    int d_cols;
+    int d_pad;
+    bool d_wrap;
+    volk::vector<float> d_power;
+
+    // Summed-area table of d_power with a leading row and column of zeros. Doubles,
+    // as the differences of large sums have to resolve the noise floor.
+    std::vector<double> d_sums;
+
+    std::vector<float> d_training; // OS-CFAR scratch
+    std::vector<float> d_range, d_doppler, d_detected_power, d_snr;
+
+    /*!
+     * Sum over rows [r0, r1] and columns [c0, c1] of the padded map
+     */
+    double sum(int r0, int r1, int c0, int c1) const;
+
+    /*!
+     * Number of cells of rows [r0, r1] and columns [c0, c1] of the padded map that lie
+     * within the map or its wrapped around rows
+     */
+    int count(int r0, int r1, int c0, int c1) const;
+
+    float noise(int row, int col);
+
+    void load_map(const void *in);
+    void detect();
+
+public:
+    cfar_detector_impl(ofdmradar_params::sptr ofdm_params,
+                       cfar_mode mode,
+                       int guard_range,
+                       int guard_doppler,
+                       int train_range,
+                       int train_doppler,
+                       float threshold,
+                       float rank,
+                       bool power_input);
+    ~cfar_detector_impl();
+
+    int work(int noutput_items,
+             gr_vector_const_void_star &input_items,
+             gr_vector_void_star &output_items);
+};
+
+} // namespace ofdmradar
+} // namespace gr
+
+#endif /* INCLUDED_OFDMRADAR_CFAR_DETECTOR_IMPL_H */
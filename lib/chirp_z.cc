@@ -0,0 +1,110 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2021 Analog Devices, Inc.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "chirp_z.h"
+
+#include <volk/volk.h>
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+
+namespace gr {
+namespace ofdmradar {
+
+namespace {
+
+// exp(2 pi i * cycles), reduced in double precision before rounding to float
+gr_complex rotation(double cycles)
+{
+    return gr_complex(std::polar(1.0, 2 * M_PI * (cycles - std::floor(cycles))));
+}
+
+} // namespace
+
+int chirp_z::transform_length(int size, int outputs)
+{
+    return batched_fft::fast_size(size + outputs - 1);
+}
+
+chirp_z::chirp_z(int size,
+                 int outputs,
+                 int howmany,
+                 double start,
+                 double step,
+                 int sign,
+                 bool centered,
+                 gr_complex *scratch,
+                 const ofdmradar_params &params)
+    : d_size(size),
+      d_outputs(outputs),
+      d_howmany(howmany),
+      d_length(transform_length(size, outputs)),
+      d_centered(centered),
+      d_pre(size),
+      d_filter(d_length),
+      d_post(outputs),
+      d_fft(d_length, howmany, 1, d_length, FFTW_FORWARD, scratch, scratch, params),
+      d_ifft(d_length, howmany, 1, d_length, FFTW_BACKWARD, scratch, scratch, params)
+{
+    // Inputs are reordered by position, the first one is at offset
+    const double offset = centered ? size / 2 - size : 0;
+
+    // With j * k = (j^2 + k^2 - (j - k)^2) / 2, the transform is a pre-multiplication,
+    // a convolution with the chirp and a post-multiplication
+    for (int k = 0; k < size; k++)
+        d_pre[k] = rotation(sign * (start * k + step * k * k / 2));
+
+    for (int j = 0; j < outputs; j++)
+        d_post[j] = rotation(sign * ((start + j * step) * offset + step * j * j / 2));
+
+    std::fill_n(scratch, scratch_length(size, outputs, howmany), 0);
+    for (int t = 1 - size; t < outputs; t++)
+        scratch[(t + d_length) % d_length] = rotation(-sign * step * t * t / 2);
+
+    // The convolution runs unnormalised, so the scaling is folded into the filter
+    d_fft.execute(scratch, scratch);
+    for (int i = 0; i < d_length; i++)
+        d_filter[i] = scratch[i] / float(d_length);
+}
+
+void chirp_z::execute(const gr_complex *in,
+                      gr_complex *scratch,
+                      gr_complex *out,
+                      unsigned int dist) const
+{
+    const int negative = d_size - d_size / 2;
+
+    for (int i = 0; i < d_howmany; i++) {
+        const gr_complex *x = &in[i * d_size];
+        gr_complex *a = &scratch[i * d_length];
+
+        if (d_centered) {
+            volk_32fc_x2_multiply_32fc(a, &x[d_size / 2], d_pre.data(), negative);
+            volk_32fc_x2_multiply_32fc(
+                &a[negative], x, &d_pre[negative], d_size / 2);
+        } else {
+            volk_32fc_x2_multiply_32fc(a, x, d_pre.data(), d_size);
+        }
+        std::fill(&a[d_size], &a[d_length], 0);
+    }
+
+    d_fft.execute(scratch, scratch);
+    for (int i = 0; i < d_howmany; i++)
+        volk_32fc_x2_multiply_32fc(&scratch[i * d_length],
+                                   &scratch[i * d_length],
+                                   d_filter.data(),
+                                   d_length);
+    d_ifft.execute(scratch, scratch);
+
+    for (int i = 0; i < d_howmany; i++)
+        volk_32fc_x2_multiply_32fc(
+            &out[i * dist], &scratch[i * d_length], d_post.data(), d_outputs);
+}
+
+} /* namespace ofdmradar */
+} /* namespace gr */
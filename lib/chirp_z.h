@@ -0,0 +1,97 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2021 Analog Devices, Inc.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef INCLUDED_OFDMRADAR_CHIRP_Z_H
+#define INCLUDED_OFDMRADAR_CHIRP_Z_H
+
+#include "batched_fft.h"
+
+#include <volk/volk_alloc.hh>
+
+namespace gr {
+namespace ofdmradar {
+
+/*!
+ * \brief A batch of chirp-Z transforms, evaluating the spectrum of size inputs at
+ *        outputs equally spaced, arbitrary frequencies.
+ *
+ * Output j of every transform is
+ *
+ *   X[j] = sum_k x[k] * exp(sign * 2 pi i * (start + j * step) * p(k))
+ *
+ * with frequencies in cycles per input and p(k) the position of input k. Bluestein's
+ * algorithm turns this into a convolution with a chirp, carried out by two transforms
+ * of length(), which is the first size with small prime factors that holds size +
+ * outputs - 1 elements.
+ */
+class chirp_z
+{
+private:
+    int d_size;
+    int d_outputs;
+    int d_howmany;
+    int d_length;
+    bool d_centered;
+    volk::vector<gr_complex> d_pre;
+    volk::vector<gr_complex> d_filter;
+    volk::vector<gr_complex> d_post;
+    batched_fft d_fft;
+    batched_fft d_ifft;
+
+public:
+    /*!
+     * \param size     Number of inputs of every transform
+     * \param outputs  Number of frequencies to evaluate
+     * \param howmany  Number of transforms in the batch, inputs are packed with a
+     *                 distance of size
+     * \param start    First frequency in cycles per input
+     * \param step     Frequency spacing in cycles per input
+     * \param sign     FFTW_FORWARD or FFTW_BACKWARD
+     * \param centered If true, the inputs are a spectrum in FFT order and inputs
+     *                 k >= size / 2 are at p(k) = k - size. Otherwise p(k) = k.
+     * \param scratch  Scratch buffer of scratch_length() elements used for planning
+     * \param params   Supplies the planning effort and the wisdom file
+     */
+    chirp_z(int size,
+            int outputs,
+            int howmany,
+            double start,
+            double step,
+            int sign,
+            bool centered,
+            gr_complex *scratch,
+            const ofdmradar_params &params);
+
+    /*!
+     * Transform length used for a given number of inputs and outputs
+     */
+    static int transform_length(int size, int outputs);
+
+    /*!
+     * Scratch buffer length required by a batch
+     */
+    static size_t scratch_length(int size, int outputs, int howmany)
+    {
+        return size_t(howmany) * transform_length(size, outputs);
+    }
+
+    /*!
+     * Transforms the batch, output j of transform i is stored at out[i * dist + j].
+     * Out may be scratch itself if dist is length().
+     */
+    void execute(const gr_complex *in,
+                 gr_complex *scratch,
+                 gr_complex *out,
+                 unsigned int dist) const;
+
+    int length() const { return d_length; }
+};
+
+} // namespace ofdmradar
+} // namespace gr
+
+#endif /* INCLUDED_OFDMRADAR_CHIRP_Z_H */
@@ -0,0 +1,63 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2021 Analog Devices, Inc.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef INCLUDED_OFDMRADAR_DOPPLER_ROWS_H
+#define INCLUDED_OFDMRADAR_DOPPLER_ROWS_H
+
+#include <ofdmradar/ofdmradar.h>
+
+#include <volk/volk.h>
+
+#include <cstring>
+
+namespace gr {
+namespace ofdmradar {
+
+/*
+ * Helpers for the blocks that look at the periodogram with its doppler rows sorted from
+ * negative to positive, while the receiver outputs them in FFT order.
+ */
+
+/*!
+ * Row of the FFT ordered input that holds row of the sorted map
+ */
+inline int doppler_input_row(int row, int rows)
+{
+    return row < rows / 2 ? row + (rows + 1) / 2 : row - rows / 2;
+}
+
+/*!
+ * Whether the doppler axis wraps around, which it does if the map holds all
+ * peri_symbols() doppler bins at the periodogram spacing
+ */
+inline bool doppler_wraps(const ofdmradar_params &params)
+{
+    return !params.zoomed() && params.roi_symbols() == params.peri_symbols();
+}
+
+/*!
+ * Writes the power of a rows x cols map to out, sorted into ascending doppler. in
+ * holds the power if power_input is set and the complex periodogram otherwise.
+ */
+inline void
+load_doppler_rows(const void *in, bool power_input, int rows, int cols, float *out)
+{
+    for (int row = 0; row < rows; row++) {
+        float *dst = &out[row * cols];
+        const int src = doppler_input_row(row, rows) * cols;
+        if (power_input)
+            std::memcpy(dst, &static_cast<const float *>(in)[src], sizeof(float) * cols);
+        else
+            volk_32fc_magnitude_squared_32f(
+                dst, &static_cast<const gr_complex *>(in)[src], cols);
+    }
+}
+
+} // namespace ofdmradar
+} // namespace gr
+
+#endif /* INCLUDED_OFDMRADAR_DOPPLER_ROWS_H */
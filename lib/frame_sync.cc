@@ -0,0 +1,162 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2021 Analog Devices, Inc.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "frame_sync.h"
+
+#include <volk/volk.h>
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstring>
+
+namespace gr {
+namespace ofdmradar {
+
+namespace {
+
+// Minimum ratio of the correlation peak to the mean correlation power. Noise alone
+// peaks at about ln(period) times its mean, a frame at about frame_length times the
+// SNR.
+constexpr float acquisition_threshold = 30;
+
+// Weight of a new measurement in the drift estimate
+constexpr float drift_gain = 0.25f;
+
+} // namespace
+
+frame_sync::frame_sync(const gr_complex *reference,
+                       size_t period,
+                       const ofdmradar_params &params)
+    : d_period(period),
+      d_frame_length(params.frame_length()),
+      d_window(period + d_frame_length - 1),
+      d_carriers(params.carriers()),
+      d_max_correction(params.cyclic_prefix_length() / 2),
+      d_reference(batched_fft::fast_size(d_window)),
+      d_buffer(d_reference.size()),
+      d_fft(d_buffer.size(),
+            1,
+            1,
+            d_buffer.size(),
+            FFTW_FORWARD,
+            d_buffer.data(),
+            d_buffer.data(),
+            params),
+      d_ifft(d_buffer.size(),
+             1,
+             1,
+             d_buffer.size(),
+             FFTW_BACKWARD,
+             d_buffer.data(),
+             d_buffer.data(),
+             params)
+{
+    std::copy_n(reference, d_frame_length, d_reference.begin());
+    d_fft.execute(d_reference.data(), d_reference.data());
+    for (auto &x : d_reference)
+        x = std::conj(x);
+}
+
+size_t frame_sync::buffer(const gr_complex *in, size_t nitems)
+{
+    const size_t count = std::min(nitems, d_window - d_buffered);
+    std::memcpy(&d_buffer[d_buffered], in, sizeof(gr_complex) * count);
+    return buffered(count);
+}
+
+size_t frame_sync::buffer(const lv_16sc_t *in, size_t nitems)
+{
+    // The correlation does not depend on the scale of the samples
+    const size_t count = std::min(nitems, d_window - d_buffered);
+    volk_16ic_convert_32fc(&d_buffer[d_buffered], in, count);
+    return buffered(count);
+}
+
+size_t frame_sync::buffered(size_t count)
+{
+    d_buffered += count;
+
+    if (d_buffered == d_window)
+        acquire();
+
+    return count;
+}
+
+void frame_sync::acquire()
+{
+    // The zero padding keeps circular wrap-around out of the first period lags
+    std::fill(&d_buffer[d_window], d_buffer.data() + d_buffer.size(), 0);
+    d_fft.execute(d_buffer.data(), d_buffer.data());
+    volk_32fc_x2_multiply_32fc(
+        d_buffer.data(), d_buffer.data(), d_reference.data(), d_buffer.size());
+    d_ifft.execute(d_buffer.data(), d_buffer.data());
+
+    size_t peak = 0;
+    float peak_power = 0;
+    double total_power = 0;
+    for (size_t lag = 0; lag < d_period; lag++) {
+        const float power = std::norm(d_buffer[lag]);
+        total_power += power;
+        if (power > peak_power) {
+            peak = lag;
+            peak_power = power;
+        }
+    }
+
+    // Try again on the next window if there is no frame in this one
+    d_buffered = 0;
+    if (peak_power < acquisition_threshold * total_power / d_period)
+        return;
+
+    d_acquired = true;
+    d_next_frame = (peak + d_period - d_window % d_period) % d_period;
+}
+
+gr_complex frame_sync::phase_slope(const gr_complex *h, unsigned int length)
+{
+    gr_complex slope = 0;
+    if (length > 1)
+        volk_32fc_x2_conjugate_dot_prod_32fc(&slope, &h[1], h, length - 1);
+    return slope;
+}
+
+int frame_sync::correction(gr_complex slope)
+{
+    if (std::norm(slope) == 0)
+        return 0;
+
+    // A delay of t samples turns the phase by -2 pi t / carriers per carrier
+    const float timing = -std::arg(slope) * d_carriers / (2 * M_PI);
+
+    if (!d_tracking) {
+        d_tracking = true;
+        d_reference_timing = timing;
+        d_error = 0;
+        d_drift = 0;
+        d_correction = 0;
+        return 0;
+    }
+
+    // The clocks drift steadily, so the next frame starts a little off again even
+    // after correcting the error of this one
+    const float error = timing - d_reference_timing;
+    d_drift += drift_gain * (error - (d_error - d_correction) - d_drift);
+    d_error = error;
+
+    // Noise must not make the timing toggle between two neighbouring samples
+    const float expected = error + d_drift;
+    if (std::abs(expected) < 1)
+        d_correction = 0;
+    else
+        d_correction = std::max(-d_max_correction,
+                                std::min(d_max_correction, int(std::lround(expected))));
+    return d_correction;
+}
+
+} /* namespace ofdmradar */
+} /* namespace gr */
@@ -0,0 +1,104 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2021 Analog Devices, Inc.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef INCLUDED_OFDMRADAR_FRAME_SYNC_H
+#define INCLUDED_OFDMRADAR_FRAME_SYNC_H
+
+#include "batched_fft.h"
+
+#include <volk/volk_alloc.hh>
+#include <volk/volk_complex.h>
+
+namespace gr {
+namespace ofdmradar {
+
+/*!
+ * \brief Finds the start of the known TX frame in a received stream and tracks its
+ *        drift afterwards.
+ *
+ * Acquisition buffers a window of period + frame_length - 1 samples, which holds at
+ * least one complete frame wherever the period starts. The window is cross-correlated
+ * with the reference frame by a single transform of fast_size() length, multiplied
+ * with the precomputed reference spectrum and transformed back. The strongest
+ * correlation marks the frame start.
+ *
+ * Tracking measures the timing of every following frame from its channel estimates.
+ * Thanks to the cyclic prefix, a symbol received a little early or late still holds
+ * one whole period of the signal, only rotated. Its channel estimate then has a
+ * phase that grows linearly over the carriers, by 2 pi / carriers per sample of
+ * delay. The timing of the first frame after acquisition is the reference. Later
+ * frames are corrected whenever the next one is expected to be off by a sample or
+ * more, taking the drift from frame to frame into account.
+ */
+class frame_sync
+{
+private:
+    size_t d_period;
+    size_t d_frame_length;
+    size_t d_window;
+    unsigned int d_carriers;
+    int d_max_correction;
+    volk::vector<gr_complex> d_reference; // Conjugated spectrum of the reference frame
+    volk::vector<gr_complex> d_buffer;
+    size_t d_buffered = 0;
+    bool d_acquired = false;
+    size_t d_next_frame = 0;
+    batched_fft d_fft;
+    batched_fft d_ifft;
+
+    bool d_tracking = false;
+    float d_reference_timing = 0;
+    float d_error = 0;       // Timing of the last frame relative to the reference
+    float d_drift = 0;       // Samples per frame
+    int d_correction = 0;    // Last correction returned
+
+    size_t buffered(size_t count);
+    void acquire();
+
+public:
+    /*!
+     * \param reference The TX frame, frame_length() samples
+     * \param period    Samples from the start of one frame to the next
+     * \param params    OFDM parameters, also supplying the planning effort and the
+     *                  wisdom file
+     */
+    frame_sync(const gr_complex *reference,
+               size_t period,
+               const ofdmradar_params &params);
+
+    /*!
+     * Adds up to nitems samples to the acquisition window and acquires once it is
+     * complete. Returns the number of samples used.
+     */
+    size_t buffer(const gr_complex *in, size_t nitems);
+    size_t buffer(const lv_16sc_t *in, size_t nitems);
+
+    bool acquired() const { return d_acquired; }
+
+    /*!
+     * Samples from the end of the acquisition window to the next frame start
+     */
+    size_t next_frame() const { return d_next_frame; }
+
+    /*!
+     * Sum of h[k + 1] * conj(h[k]) over channel estimates h of length adjacent
+     * carriers
+     */
+    static gr_complex phase_slope(const gr_complex *h, unsigned int length);
+
+    /*!
+     * Ends a frame, given the sum of the phase_slope() of all of its symbols. Returns
+     * the number of samples its successor starts later than expected, or earlier if
+     * negative, at most half a cyclic prefix either way.
+     */
+    int correction(gr_complex slope);
+};
+
+} // namespace ofdmradar
+} // namespace gr
+
+#endif /* INCLUDED_OFDMRADAR_FRAME_SYNC_H */
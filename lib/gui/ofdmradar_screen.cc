@@ -15,8 +15,8 @@
 OFDMRadarScreen::OFDMRadarScreen(ofdmradar_params::sptr ofdm_params, QWidget *parent)
     : QOpenGLWidget(parent),
       d_ofdm_params(ofdm_params),
-      d_front_buffer(ofdm_params->peri_length()),
-      d_back_buffer(ofdm_params->peri_length())
+      d_front_buffer(ofdm_params->roi_length()),
+      d_back_buffer(ofdm_params->roi_length())
 {
     setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
     setAutoFillBackground(false);
@@ -82,13 +82,13 @@ void OFDMRadarScreen::initializeGL()
 
     d_texture = new QOpenGLTexture(QOpenGLTexture::Target2D);
     d_texture->setFormat(QOpenGLTexture::RG32F);
-    d_texture->setSize(d_ofdm_params->peri_carriers(), d_ofdm_params->peri_symbols());
+    d_texture->setSize(d_ofdm_params->roi_carriers(), d_ofdm_params->roi_symbols());
     d_texture->allocateStorage(QOpenGLTexture::RG, QOpenGLTexture::Float32);
     d_texture->setData(0,
                        0,
                        0,
-                       d_ofdm_params->peri_carriers(),
-                       d_ofdm_params->peri_symbols(),
+                       d_ofdm_params->roi_carriers(),
+                       d_ofdm_params->roi_symbols(),
                        1,
                        QOpenGLTexture::RG,
                        QOpenGLTexture::Float32,
@@ -131,8 +131,8 @@ void OFDMRadarScreen::paintGL()
         d_texture->setData(0,
                            0,
                            0,
-                           d_ofdm_params->peri_carriers(),
-                           d_ofdm_params->peri_symbols(),
+                           d_ofdm_params->roi_carriers(),
+                           d_ofdm_params->roi_symbols(),
                            1,
                            QOpenGLTexture::RG,
                            QOpenGLTexture::Float32,
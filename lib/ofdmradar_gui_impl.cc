@@ -29,7 +29,7 @@ ofdmradar_gui_impl::ofdmradar_gui_impl(ofdmradar_params::sptr ofdm_params,
                      gr::io_signature::make(0, 0, 0)),
       d_parent(parent),
       d_ofdm_params(ofdm_params),
-      d_buffer_size(ofdm_params->peri_length())
+      d_buffer_size(ofdm_params->roi_length())
 {
     this->set_output_multiple(d_buffer_size);
     initialize_qt();
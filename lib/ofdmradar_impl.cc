@@ -6,6 +6,7 @@
  */
 
 #include "ofdmradar_impl.h"
+#include "philox.h"
 
 #include <ofdmradar/ofdmradar.h>
 
@@ -111,7 +112,14 @@ ofdmradar_params::sptr ofdmradar_params::make(unsigned int carriers,
                                               unsigned int nyquist_guard,
                                               int window_type,
                                               std::vector<gr_complex> constellation,
-                                              unsigned int seed)
+                                              unsigned int seed,
+                                              fft_effort planning_effort,
+                                              const std::string &wisdom_file,
+                                              unsigned int roi_carriers,
+                                              unsigned int roi_symbols,
+                                              float zoom,
+                                              float zoom_range,
+                                              float zoom_doppler)
 {
     return std::make_shared<ofdmradar_params>(carriers,
                                               symbols,
@@ -122,7 +130,14 @@ ofdmradar_params::sptr ofdmradar_params::make(unsigned int carriers,
                                               nyquist_guard,
                                               window_type,
                                               std::move(constellation),
-                                              seed);
+                                              seed,
+                                              planning_effort,
+                                              wisdom_file,
+                                              roi_carriers,
+                                              roi_symbols,
+                                              zoom,
+                                              zoom_range,
+                                              zoom_doppler);
 }
 
 ofdmradar_params::ofdmradar_params(unsigned int carriers,
@@ -134,11 +149,23 @@ ofdmradar_params::ofdmradar_params(unsigned int carriers,
                                    unsigned int nyquist_guard,
                                    int window_type,
                                    std::vector<gr_complex> constellation,
-                                   unsigned int seed)
+                                   unsigned int seed,
+                                   fft_effort planning_effort,
+                                   const std::string &wisdom_file,
+                                   unsigned int roi_carriers,
+                                   unsigned int roi_symbols,
+                                   float zoom,
+                                   float zoom_range,
+                                   float zoom_doppler)
     : d_carriers(carriers),
       d_symbols(symbols),
       d_peri_carriers(peri_carriers),
       d_peri_symbols(peri_symbols),
+      d_roi_carriers(roi_carriers ? roi_carriers : peri_carriers),
+      d_roi_symbols(roi_symbols ? roi_symbols : peri_symbols),
+      d_zoom(zoom),
+      d_zoom_range(zoom_range),
+      d_zoom_doppler(zoom_doppler),
       d_cyclic_prefix_length(cyclic_prefix_length),
       d_dc_guard(dc_guard),
       d_nyquist_guard(nyquist_guard),
@@ -147,7 +174,9 @@ ofdmradar_params::ofdmradar_params(unsigned int carriers,
       d_seed(seed),
       d_symbol_length(carriers + cyclic_prefix_length),
       d_frame_length(d_symbol_length * symbols),
-      d_carrier_mask(carriers)
+      d_carrier_mask(carriers),
+      d_planning_effort(planning_effort),
+      d_wisdom_file(wisdom_file)
 {
     if (peri_carriers < carriers)
         throw std::runtime_error(
@@ -161,6 +190,16 @@ ofdmradar_params::ofdmradar_params(unsigned int carriers,
                                      ">= ofdm symbols (%u)!") %
                        peri_symbols % symbols));
 
+    if (d_roi_carriers > peri_carriers || d_roi_symbols > peri_symbols)
+        throw std::runtime_error(
+            boost::str(boost::format("ofdmradar_params: Region of interest (%u x %u) "
+                                     "exceeds the periodogram (%u x %u)!") %
+                       d_roi_carriers % d_roi_symbols % peri_carriers % peri_symbols));
+
+    if (!(zoom > 0))
+        throw std::runtime_error(boost::str(
+            boost::format("ofdmradar_params: Zoom (%f) must be positive!") % zoom));
+
     // Generate carrier mask
     for (size_t i = 0; i < d_carrier_mask.size(); i++)
         d_carrier_mask[i] = !(i > carriers - dc_guard || i < dc_guard) &&
@@ -200,26 +239,71 @@ std::string constellation_to_string(const std::vector<gr_complex> cst)
     return ss.str();
 }
 
+const char *fft_effort_to_string(fft_effort effort)
+{
+    switch (effort) {
+    case fft_effort::ESTIMATE:
+        return "ESTIMATE";
+    case fft_effort::MEASURE:
+        return "MEASURE";
+    case fft_effort::PATIENT:
+        return "PATIENT";
+    }
+    return "UNKNOWN";
+}
+
+// Calls fn(carrier, index) with the constellation index drawn for every carrier of a
+// symbol. Every carrier draws its own word, whether it is active or not.
+template <typename F>
+void draw_tx_indices(const ofdmradar_params &params,
+                     unsigned int symbol,
+                     uint64_t frame,
+                     F fn)
+{
+    const auto n = params.carriers();
+    const uint32_t points = params.constellation().size();
+    const philox4x32::key_type key = { params.seed(), 0 };
+
+    for (unsigned int i = 0; i < n; i += 4) {
+        const auto words = philox4x32::generate(
+            { i / 4, symbol, uint32_t(frame), uint32_t(frame >> 32) }, key);
+        for (unsigned int j = 0; j < 4 && i + j < n; j++)
+            fn(i + j, philox4x32::below(words[j], points));
+    }
+}
+
 } // namespace
 
 std::string ofdmradar_params::python_str() const
 {
     return boost::str(
         boost::format(
-            "{carriers: %u, symbols: %u, cyclic_prefix_length: %u, dc_guard: %u, "
-            "nyquist_guard: %u, constellation: %s, seed: %u}") %
-        carriers() % symbols() % cyclic_prefix_length() % dc_guard() % nyquist_guard() %
-        constellation_to_string(constellation()) % seed());
+            "{carriers: %u, symbols: %u, peri_carriers: %u, peri_symbols: %u, "
+            "cyclic_prefix_length: %u, dc_guard: %u, nyquist_guard: %u, "
+            "window_type: %d, constellation: %s, seed: %u, planning_effort: %s, "
+            "wisdom_file: '%s', roi_carriers: %u, roi_symbols: %u, zoom: %g, "
+            "zoom_range: %g, zoom_doppler: %g}") %
+        carriers() % symbols() % peri_carriers() % peri_symbols() %
+        cyclic_prefix_length() % dc_guard() % nyquist_guard() % window_type() %
+        constellation_to_string(constellation()) % seed() %
+        fft_effort_to_string(planning_effort()) % wisdom_file() % roi_carriers() %
+        roi_symbols() % zoom() % zoom_range() % zoom_doppler());
 }
 
 std::string ofdmradar_params::python_repr() const
 {
-    return boost::str(boost::format("ofdmradar_params(carriers=%u, symbols=%u, "
-                                    "cyclic_prefix_length=%u, dc_guard=%u, "
-                                    "nyquist_guard=%u, constellation=%s, seed=%u)") %
-                      carriers() % symbols() % cyclic_prefix_length() % dc_guard() %
-                      nyquist_guard() % constellation_to_string(constellation()) %
-                      seed());
+    return boost::str(
+        boost::format(
+            "ofdmradar_params(carriers=%u, symbols=%u, peri_carriers=%u, "
+            "peri_symbols=%u, cyclic_prefix_length=%u, dc_guard=%u, nyquist_guard=%u, "
+            "window_type=%d, constellation=%s, seed=%u, "
+            "planning_effort=fft_effort.%s, wisdom_file='%s', roi_carriers=%u, "
+            "roi_symbols=%u, zoom=%g, zoom_range=%g, zoom_doppler=%g)") %
+        carriers() % symbols() % peri_carriers() % peri_symbols() %
+        cyclic_prefix_length() % dc_guard() % nyquist_guard() % window_type() %
+        constellation_to_string(constellation()) % seed() %
+        fft_effort_to_string(planning_effort()) % wisdom_file() % roi_carriers() %
+        roi_symbols() % zoom() % zoom_range() % zoom_doppler());
 }
 
 //
@@ -227,62 +311,31 @@ std::string ofdmradar_params::python_repr() const
 //
 
 ofdmradar_shared::ofdmradar_shared(ofdmradar_params::sptr ofdm_params)
-    : d_ofdm_params(ofdm_params),
-      d_generator(ofdm_params->seed()),
-      d_distribution(0, ofdm_params->constellation().size() - 1)
+    : d_ofdm_params(ofdm_params)
 {
-    auto fft_size = std::max({ ofdm_params->carriers(),
-                               ofdm_params->symbols(),
-                               ofdm_params->peri_carriers(),
-                               ofdm_params->peri_symbols() }) *
-                    sizeof(fftwf_complex);
-    d_fft_in = (fftwf_complex *)fftwf_malloc(fft_size);
-    if (!d_fft_in)
-        throw std::runtime_error("ofdmradar_tx: Failed to allocate FFT in buffer!");
-
-    d_fft_out = (fftwf_complex *)fftwf_malloc(fft_size);
-    if (!d_fft_out) {
-        fftwf_free(d_fft_in);
-        throw std::runtime_error("ofdmradar_tx: Failed to allocate FFT out buffer!");
-    }
-
-    d_fft_plan = fftwf_plan_dft_1d(
-        d_ofdm_params->carriers(), d_fft_in, d_fft_out, FFTW_FORWARD, FFTW_MEASURE);
-    if (!d_fft_plan) {
-        fftwf_free(d_fft_in);
-        fftwf_free(d_fft_out);
-        throw std::runtime_error("ofdmradar_tx: Failed to create execution plan!");
-    }
-
-    d_ifft_plan = fftwf_plan_dft_1d(
-        d_ofdm_params->carriers(), d_fft_in, d_fft_out, FFTW_BACKWARD, FFTW_MEASURE);
-    if (!d_ifft_plan) {
-        fftwf_destroy_plan(d_fft_plan);
-        fftwf_free(d_fft_in);
-        fftwf_free(d_fft_out);
-        throw std::runtime_error("ofdmradar_tx: Failed to create ifft execution plan!");
-    }
-
-    d_fft_gr_in = reinterpret_cast<gr_complex *>(d_fft_in);
-    d_fft_gr_out = reinterpret_cast<gr_complex *>(d_fft_out);
 }
 
-ofdmradar_shared::~ofdmradar_shared()
+ofdmradar_shared::~ofdmradar_shared() {}
+
+void ofdmradar_shared::generate_tx_indices(uint8_t *out,
+                                           unsigned int symbol,
+                                           uint64_t frame) const
 {
-    fftwf_destroy_plan(d_ifft_plan);
-    fftwf_destroy_plan(d_fft_plan);
-    fftwf_free(d_fft_in);
-    fftwf_free(d_fft_out);
+    draw_tx_indices(*d_ofdm_params, symbol, frame, [out](unsigned int i, uint32_t index) {
+        out[i] = index;
+    });
 }
 
-void ofdmradar_shared::generate_tx_symbols(gr_complex *out)
+void ofdmradar_shared::generate_tx_symbols(gr_complex *out,
+                                           unsigned int symbol,
+                                           uint64_t frame) const
 {
-    for (unsigned int i = 0; i < d_ofdm_params->carriers(); i++) {
-        if (d_ofdm_params->carrier_mask()[i])
-            out[i] = d_ofdm_params->constellation()[d_distribution(d_generator)];
-        else
-            out[i] = 0;
-    }
+    const auto &mask = d_ofdm_params->carrier_mask();
+    const auto &constellation = d_ofdm_params->constellation();
+
+    draw_tx_indices(*d_ofdm_params, symbol, frame, [&](unsigned int i, uint32_t index) {
+        out[i] = mask[i] ? constellation[index] : 0;
+    });
 }
 
 } /* namespace ofdmradar */
@@ -10,36 +10,37 @@
 
 #include <ofdmradar/ofdmradar.h>
 
-#include <fftw3.h>
+#include <cstdint>
 #include <cstdlib>
-#include <random>
 
 namespace gr {
 namespace ofdmradar {
 
 /*!
  * \brief Shared internals of ofdmradar blocks
+ *
+ * Exported for the unit tests only.
  */
-class ofdmradar_shared
+class OFDMRADAR_API ofdmradar_shared
 {
-private:
-    std::default_random_engine d_generator;
-    std::uniform_int_distribution<unsigned int> d_distribution;
-
 protected:
     ofdmradar_params::sptr d_ofdm_params;
 
-    fftwf_plan d_fft_plan;
-    fftwf_plan d_ifft_plan;
-    fftwf_complex *d_fft_in;
-    fftwf_complex *d_fft_out;
-    gr_complex *d_fft_gr_in;
-    gr_complex *d_fft_gr_out;
+    /*!
+     * Writes the random constellation points of one OFDM symbol of a frame to out,
+     * zero on inactive carriers. Every symbol is drawn from a counter-based
+     * generator keyed on the seed, so it can be generated on its own and from any
+     * thread.
+     */
+    void generate_tx_symbols(gr_complex *out,
+                             unsigned int symbol,
+                             uint64_t frame = 0) const;
 
     /*!
-     * Selects a bunch of random symbols and writes them to out.
+     * Writes the constellation indices of all carriers of one OFDM symbol to out, the
+     * same ones generate_tx_symbols() draws. Requires at most 256 constellation points.
      */
-    void generate_tx_symbols(gr_complex *out);
+    void generate_tx_indices(uint8_t *out, unsigned int symbol, uint64_t frame = 0) const;
 
 public:
     ofdmradar_shared(ofdmradar_params::sptr params);
@@ -9,23 +9,120 @@
 
 #include <gnuradio/fft/window.h>
 #include <gnuradio/io_signature.h>
+#include <volk/volk.h>
 
+#include <boost/format.hpp>
+
+#include <algorithm>
 #include <cmath>
 #include <cstring>
+#include <thread>
 
 namespace gr {
 namespace ofdmradar {
 
 ofdmradar_rx::sptr ofdmradar_rx::make(ofdmradar_params::sptr ofdm_params,
                                       const std::string &len_tag_key,
-                                      size_t buffer_size)
+                                      size_t buffer_size,
+                                      int nthreads,
+                                      int frame_buffers,
+                                      int hop,
+                                      bool acquire,
+                                      sample_format format,
+                                      int integration,
+                                      bool exponential,
+                                      float clutter_alpha,
+                                      bool notch,
+                                      int channels,
+                                      int waveforms)
 {
-    return gnuradio::make_block_sptr<ofdmradar_rx_impl>(
-        ofdm_params, len_tag_key, buffer_size);
+    return gnuradio::make_block_sptr<ofdmradar_rx_impl>(ofdm_params,
+                                                        len_tag_key,
+                                                        buffer_size,
+                                                        nthreads,
+                                                        frame_buffers,
+                                                        hop,
+                                                        acquire,
+                                                        format,
+                                                        integration,
+                                                        exponential,
+                                                        clutter_alpha,
+                                                        notch,
+                                                        channels,
+                                                        waveforms);
 }
 
 namespace {
 
+// Number of symbols range processed together. Frames are always split the same way,
+// so the result does not depend on how many threads share the work. Sliding CPIs use
+// smaller batches if needed, so every CPI ends on a batch boundary.
+constexpr unsigned int range_batch_symbols = 8;
+
+// Number of range bins transposed and doppler transformed together. A row of the tile
+// spans two cache lines, the whole tile stays in L2 for common peri_symbols sizes.
+constexpr unsigned int doppler_tile_width = 16;
+
+// The doppler transform is pruned when the periodogram pads the symbols by an integer
+// factor of at least this much and the padded length reaches pruned_doppler_length.
+// Shorter transforms are faster done in full over the zeros.
+constexpr unsigned int pruned_doppler_factor = 8;
+constexpr unsigned int pruned_doppler_length = 8192;
+
+// Largest table of TX constellation indices kept in memory, in bytes. Beyond that,
+// the indices of every symbol are regenerated while it is range processed, which
+// trades about as much compute as the range FFT for the memory of huge frames.
+constexpr size_t max_index_table = 32 << 20;
+
+unsigned int gcd(unsigned int a, unsigned int b)
+{
+    while (b) {
+        const unsigned int r = a % b;
+        a = b;
+        b = r;
+    }
+    return a;
+}
+
+size_t item_size(sample_format format)
+{
+    return format == sample_format::SC16 ? sizeof(lv_16sc_t) : sizeof(gr_complex);
+}
+
+// Range FFTs read whole batches straight from the input buffer, if it holds floats
+const gr_complex *direct_input(const gr_complex *in) { return in; }
+const gr_complex *direct_input(const lv_16sc_t *) { return nullptr; }
+
+void load_symbol(gr_complex *out, const gr_complex *in, unsigned int n)
+{
+    std::memcpy(out, in, sizeof(gr_complex) * n);
+}
+
+// Their scale is taken care of by the compensation
+void load_symbol(gr_complex *out, const lv_16sc_t *in, unsigned int n)
+{
+    volk_16ic_convert_32fc(out, in, n);
+}
+
+// Interleaves length elements of every channel, which are dist apart in the input, so
+// the channel index runs fastest in the output
+template <typename T>
+void interleave(T *out,
+                const T *in,
+                unsigned int channels,
+                size_t dist,
+                unsigned int length)
+{
+    if (channels == 1) {
+        std::memcpy(out, in, sizeof(T) * length);
+        return;
+    }
+
+    for (unsigned int i = 0; i < length; i++)
+        for (unsigned int ch = 0; ch < channels; ch++)
+            out[i * channels + ch] = in[ch * dist + i];
+}
+
 // Only to be used for even sizes
 unsigned int fftshift(unsigned int i, unsigned int N)
 {
@@ -52,6 +149,24 @@ unsigned int pad_spectrum(unsigned int i, unsigned int from, unsigned int to)
     return to - from + i;
 }
 
+// Doppler bin of an output row, rows around zero velocity are kept in FFT order
+unsigned int roi_doppler_bin(unsigned int row, unsigned int roi_m, unsigned int peri_m)
+{
+    if (row < (roi_m + 1) / 2)
+        return row;
+
+    return peri_m - roi_m + row;
+}
+
+// Output row of chirp-Z output j, which counts up from the most negative doppler
+unsigned int zoom_doppler_row(unsigned int j, unsigned int roi_m)
+{
+    if (j < roi_m / 2)
+        return j + (roi_m + 1) / 2;
+
+    return j - roi_m / 2;
+}
+
 } // namespace
 
 
@@ -60,34 +175,338 @@ unsigned int pad_spectrum(unsigned int i, unsigned int from, unsigned int to)
  */
 ofdmradar_rx_impl::ofdmradar_rx_impl(ofdmradar_params::sptr ofdm_params,
                                      const std::string &len_tag_key,
-                                     size_t buffer_size)
+                                     size_t buffer_size,
+                                     int nthreads,
+                                     int frame_buffers,
+                                     int hop,
+                                     bool acquire,
+                                     sample_format format,
+                                     int integration,
+                                     bool exponential,
+                                     float clutter_alpha,
+                                     bool notch,
+                                     int channels,
+                                     int waveforms)
     : gr::block("ofdmradar_rx",
-                gr::io_signature::make(1, 1, sizeof(gr_complex)),
-                gr::io_signature::make(1, 1, sizeof(gr_complex))),
+                gr::io_signature::make(
+                    std::max(channels, 1), std::max(channels, 1), item_size(format)),
+                gr::io_signature::make(
+                    1,
+                    1,
+                    std::max(channels, 1) *
+                        (integration > 0 ? sizeof(float) : sizeof(gr_complex)))),
       ofdmradar_shared(ofdm_params),
+      d_channels(std::max(channels, 1)),
+      d_waveforms(std::max(waveforms, 1)),
       d_len_tag_key(pmt::intern(len_tag_key)),
-      d_out_size(ofdm_params->peri_length()),
-      d_tx_symbols(ofdm_params->carriers() * ofdm_params->symbols()),
-      d_frame_buffer(d_out_size),
+      d_waveform_tag_key(pmt::intern("waveform")),
+      d_use_tags(!len_tag_key.empty() && !acquire),
+      d_out_size(ofdm_params->roi_length()),
+      d_symbol_buffer(ofdm_params->carriers() * ofdm_params->symbols() *
+                      std::max(channels, 1)),
+      d_range_batch(range_batch_symbols),
       d_buffer_size(buffer_size),
-      d_window_carriers(ofdm_params->carriers()),
-      d_window_symbols(ofdm_params->symbols())
+      d_window_symbols(ofdm_params->symbols()),
+      d_workers(worker_pool::thread_count(nthreads)),
+      d_hop(hop),
+      d_cpi_remaining(ofdm_params->symbols()),
+      d_format(format),
+      d_integration(std::max(integration, 0)),
+      d_exponential(exponential),
+      d_clutter_alpha(clutter_alpha),
+      d_notch(notch)
 {
     if (buffer_size == (size_t)-1LL)
         d_buffer_size = ofdm_params->frame_length();
 
-    this->set_output_multiple(ofdm_params->peri_carriers());
+    this->set_output_multiple(ofdm_params->roi_carriers());
+
+    const int n = ofdm_params->carriers();
+    const int peri_n = ofdm_params->peri_carriers();
+    const int m = ofdm_params->symbols();
+    const int peri_m = ofdm_params->peri_symbols();
+    const int roi_n = ofdm_params->roi_carriers();
+
+    // Batches start at multiples of the row length, even sizes keep them at the
+    // alignment the plans were made for.
+    if (n % 2 || peri_n % 2)
+        throw std::runtime_error(
+            "ofdmradar_rx: Carriers and periodogram carriers must be even!");
+
+    if (frame_buffers < 1)
+        throw std::runtime_error("ofdmradar_rx: At least one frame buffer is required!");
+
+    if (channels < 1)
+        throw std::runtime_error(boost::str(
+            boost::format("ofdmradar_rx: Invalid number of channels (%d)!") % channels));
+
+    if (waveforms < 1)
+        throw std::runtime_error(boost::str(
+            boost::format("ofdmradar_rx: Invalid number of waveforms (%d)!") %
+            waveforms));
+
+    if (hop < 0 || hop > m)
+        throw std::runtime_error(
+            boost::str(boost::format("ofdmradar_rx: Hop (%d) must be between 0 and the "
+                                     "number of symbols (%d)!") %
+                       hop % m));
+
+    if (sliding() && frame_buffers > 1)
+        throw std::runtime_error("ofdmradar_rx: Sliding CPIs reuse the symbols of the "
+                                 "previous one and cannot be pipelined!");
 
-    d_doppler_fft_plan = fftwf_plan_dft_1d(
-        d_ofdm_params->peri_symbols(), d_fft_in, d_fft_out, FFTW_FORWARD, FFTW_MEASURE);
+    if (ofdm_params->constellation().size() > 256)
+        throw std::runtime_error(
+            boost::str(boost::format("ofdmradar_rx: Constellations of more than 256 "
+                                     "points (%u) are not supported!") %
+                       ofdm_params->constellation().size()));
 
-    d_peri_c_ifft_plan = fftwf_plan_dft_1d(
-        d_ofdm_params->peri_carriers(), d_fft_in, d_fft_out, FFTW_BACKWARD, FFTW_MEASURE);
+    if (clutter_alpha < 0 || clutter_alpha > 1)
+        throw std::runtime_error(
+            boost::str(boost::format("ofdmradar_rx: Clutter alpha (%g) must be between "
+                                     "0 and 1!") %
+                       clutter_alpha));
 
-    // Generate reference data
-    for (unsigned int i_s = 0; i_s < ofdm_params->symbols(); i_s++) {
-        unsigned int offset = i_s * ofdm_params->carriers();
-        generate_tx_symbols(&d_tx_symbols[offset]);
+    if (suppressing_clutter()) {
+        d_clutter_map.resize(d_channels * roi_n);
+        d_clutter_ones.assign(m, 1.0f);
+        d_clutter_window.resize(m);
+        for (unsigned int i = 0; i < worker_pool::thread_count(nthreads); i++)
+            d_clutter_scratch.emplace_back(m);
+    }
+
+    if (integrating()) {
+        d_integration_sum.resize(d_channels * ofdm_params->roi_length());
+        d_row_power.resize(roi_n);
+        for (int i = 0; i < frame_buffers; i++)
+            d_power_maps.emplace_back(d_channels * ofdm_params->roi_length());
+    }
+
+    if (sliding()) {
+        d_range_batch = gcd(range_batch_symbols, gcd(hop, m));
+        d_sliding_periodogram.resize(d_channels * ofdm_params->peri_length());
+    }
+
+    // Channels follow each other at multiples of the row length, which keeps them at
+    // the alignment of the plans, too
+    for (int i = 0; i < frame_buffers; i++)
+        d_frame_buffers.emplace_back(d_channels * ofdm_params->peri_length());
+
+    // The doppler thread needs its own workers, d_workers keeps receiving meanwhile
+    if (pipelined())
+        d_doppler_workers =
+            std::make_unique<worker_pool>(worker_pool::thread_count(nthreads));
+
+    d_batch_inputs.resize(d_channels * ((m + d_range_batch - 1) / d_range_batch));
+    if (acquire)
+        d_batch_slopes.resize(d_batch_inputs.size());
+
+    // All transforms run in place, except for the range FFTs that read whole batches
+    // of symbols straight from the input buffer
+    const int range_tail = m % d_range_batch;
+    const int symbol_length = ofdm_params->symbol_length();
+    volk::vector<gr_complex> stream((d_range_batch - 1) * symbol_length + n);
+    if (m >= d_range_batch) {
+        d_range_fft = std::make_unique<batched_fft>(n,
+                                                    d_range_batch,
+                                                    1,
+                                                    n,
+                                                    FFTW_FORWARD,
+                                                    d_symbol_buffer.data(),
+                                                    d_symbol_buffer.data(),
+                                                    *d_ofdm_params);
+        d_range_direct_fft = std::make_unique<batched_fft>(n,
+                                                           d_range_batch,
+                                                           1,
+                                                           symbol_length,
+                                                           n,
+                                                           FFTW_FORWARD,
+                                                           stream.data(),
+                                                           d_symbol_buffer.data(),
+                                                           *d_ofdm_params);
+    }
+    if (range_tail) {
+        d_range_tail_fft = std::make_unique<batched_fft>(n,
+                                                         range_tail,
+                                                         1,
+                                                         n,
+                                                         FFTW_FORWARD,
+                                                         d_symbol_buffer.data(),
+                                                         d_symbol_buffer.data(),
+                                                         *d_ofdm_params);
+        d_range_direct_tail_fft = std::make_unique<batched_fft>(n,
+                                                                range_tail,
+                                                                1,
+                                                                symbol_length,
+                                                                n,
+                                                                FFTW_FORWARD,
+                                                                stream.data(),
+                                                                d_symbol_buffer.data(),
+                                                                *d_ofdm_params);
+    }
+
+    // A zoomed grid is evaluated by chirp-Z transforms of the active spectrum, which
+    // only produce the range bins of the region of interest
+    const bool zoomed = ofdm_params->zoomed();
+    const double zoom = ofdm_params->zoom();
+    const int roi_m = ofdm_params->roi_symbols();
+
+    for (unsigned int i = 0; i < d_workers.size(); i++)
+        d_range_scratch.emplace_back(
+            zoomed ? chirp_z::scratch_length(n, roi_n, d_range_batch) : 0);
+
+    if (zoomed) {
+        const double start = ofdm_params->zoom_range() / peri_n;
+        const double step = 1 / (zoom * peri_n);
+        gr_complex *scratch = d_range_scratch[0].data();
+
+        if (m >= d_range_batch)
+            d_range_czt = std::make_unique<chirp_z>(n,
+                                                    roi_n,
+                                                    d_range_batch,
+                                                    start,
+                                                    step,
+                                                    FFTW_BACKWARD,
+                                                    true,
+                                                    scratch,
+                                                    *d_ofdm_params);
+        if (range_tail)
+            d_range_tail_czt = std::make_unique<chirp_z>(n,
+                                                         roi_n,
+                                                         range_tail,
+                                                         start,
+                                                         step,
+                                                         FFTW_BACKWARD,
+                                                         true,
+                                                         scratch,
+                                                         *d_ofdm_params);
+    } else {
+        if (m >= d_range_batch)
+            d_peri_c_ifft = std::make_unique<batched_fft>(peri_n,
+                                                          d_range_batch,
+                                                          1,
+                                                          peri_n,
+                                                          FFTW_BACKWARD,
+                                                          d_frame_buffers[0].data(),
+                                                          d_frame_buffers[0].data(),
+                                                          *d_ofdm_params);
+        if (range_tail)
+            d_peri_c_tail_ifft =
+                std::make_unique<batched_fft>(peri_n,
+                                              range_tail,
+                                              1,
+                                              peri_n,
+                                              FFTW_BACKWARD,
+                                              d_frame_buffers[0].data(),
+                                              d_frame_buffers[0].data(),
+                                              *d_ofdm_params);
+    }
+
+    // Every worker transposes doppler tiles into its own scratch buffer. Pruned and
+    // chirp-Z transforms use its first part for the inputs and the rest as the
+    // scratch buffer that is transformed.
+    const size_t tile_length =
+        zoomed ? doppler_tile_width * m +
+                     chirp_z::scratch_length(m, roi_m, doppler_tile_width)
+               : doppler_tile_width * peri_m;
+    for (unsigned int i = 0; i < worker_pool::thread_count(nthreads); i++)
+        d_doppler_tiles.emplace_back(tile_length);
+
+    gr_complex *tile = d_doppler_tiles[0].data();
+    const int doppler_tail = roi_n % doppler_tile_width;
+    const unsigned int doppler_padding = peri_m % m ? 1 : peri_m / m;
+    if (zoomed) {
+        // Rows are centered around zoom_doppler, the first one is the most negative
+        const double step = 1 / (zoom * peri_m);
+        const double start =
+            ofdm_params->zoom_doppler() / peri_m - roi_m / 2 * step;
+
+        d_doppler_czt = std::make_unique<chirp_z>(m,
+                                                  roi_m,
+                                                  doppler_tile_width,
+                                                  start,
+                                                  step,
+                                                  FFTW_FORWARD,
+                                                  false,
+                                                  &tile[doppler_tile_width * m],
+                                                  *d_ofdm_params);
+        if (doppler_tail)
+            d_doppler_tail_czt = std::make_unique<chirp_z>(m,
+                                                           roi_m,
+                                                           doppler_tail,
+                                                           start,
+                                                           step,
+                                                           FFTW_FORWARD,
+                                                           false,
+                                                           &tile[doppler_tile_width * m],
+                                                           *d_ofdm_params);
+    } else if (doppler_padding >= pruned_doppler_factor &&
+               peri_m >= pruned_doppler_length) {
+        d_doppler_pruned_fft = std::make_unique<pruned_fft>(m,
+                                                            doppler_padding,
+                                                            doppler_tile_width,
+                                                            FFTW_FORWARD,
+                                                            &tile[doppler_tile_width * m],
+                                                            *d_ofdm_params);
+        if (doppler_tail)
+            d_doppler_pruned_tail_fft =
+                std::make_unique<pruned_fft>(m,
+                                             doppler_padding,
+                                             doppler_tail,
+                                             FFTW_FORWARD,
+                                             &tile[doppler_tile_width * m],
+                                             *d_ofdm_params);
+
+        // Output rows grouped by the residue of their doppler bin
+        d_doppler_outputs.resize(doppler_padding);
+        for (int i_r = 0; i_r < roi_m; i_r++) {
+            const unsigned int bin = roi_doppler_bin(i_r, roi_m, peri_m);
+            d_doppler_outputs[bin % doppler_padding].push_back(
+                { (unsigned int)i_r, bin / doppler_padding });
+        }
+    } else {
+        d_doppler_fft = std::make_unique<batched_fft>(peri_m,
+                                                      doppler_tile_width,
+                                                      1,
+                                                      peri_m,
+                                                      FFTW_FORWARD,
+                                                      tile,
+                                                      tile,
+                                                      *d_ofdm_params);
+        if (doppler_tail)
+            d_doppler_tail_fft = std::make_unique<batched_fft>(peri_m,
+                                                               doppler_tail,
+                                                               1,
+                                                               peri_m,
+                                                               FFTW_FORWARD,
+                                                               tile,
+                                                               tile,
+                                                               *d_ofdm_params);
+    }
+
+    // The timing is acquired by correlating with the TX frame in the time domain. With
+    // a waveform bank, that is its first frame, which only repeats every waveforms
+    // buffers.
+    if (acquire) {
+        const int cpl = ofdm_params->cyclic_prefix_length();
+        volk::vector<gr_complex> spectrum(m * n);
+        volk::vector<gr_complex> time(m * n);
+        for (int i_s = 0; i_s < m; i_s++)
+            generate_tx_symbols(&spectrum[i_s * n], i_s);
+
+        const batched_fft ifft(
+            n, m, 1, n, FFTW_BACKWARD, spectrum.data(), time.data(), *d_ofdm_params);
+        ifft.execute(spectrum.data(), time.data());
+
+        volk::vector<gr_complex> reference(ofdm_params->frame_length());
+        for (int i_s = 0; i_s < m; i_s++) {
+            gr_complex *symbol = &reference[i_s * symbol_length];
+            std::copy_n(&time[i_s * n + n - cpl], cpl, symbol);
+            std::copy_n(&time[i_s * n], n, &symbol[cpl]);
+        }
+
+        d_sync = std::make_unique<frame_sync>(
+            reference.data(), d_buffer_size * d_waveforms, *d_ofdm_params);
     }
 
     auto c_window = ofdm_params->window(ofdm_params->carriers());
@@ -103,117 +522,777 @@ ofdmradar_rx_impl::ofdmradar_rx_impl(ofdmradar_params::sptr ofdm_params,
     float norm =
         1.0f /
         std::sqrt(std::sqrt(energy / (ofdm_params->carriers() * ofdm_params->symbols())));
+    const float input_scale = format == sample_format::SC16 ? 1.0f / 32768 : 1.0f;
+
+    // Group the active carriers by where they end up in the periodogram row
+    for (unsigned int i_c = 0; i_c < n; i_c++) {
+        if (!ofdm_params->carrier_mask()[i_c])
+            continue;
+
+        const unsigned int bin = pad_spectrum(i_c, n, peri_n);
+        auto &runs = d_compensation_runs;
+        if (!runs.empty() && runs.back().carrier + runs.back().length == i_c &&
+            runs.back().bin + runs.back().length == bin)
+            runs.back().length++;
+        else
+            runs.push_back({ i_c, bin, 1 });
+        d_active_carriers++;
+    }
 
-    for (unsigned int i = 0; i < c_window.size(); i++)
-        this->d_window_carriers[i] =
-            c_window[fftshift(i, ofdm_params->carriers())] * norm;
+    // Carrier window and input scale, in the order the runs consume them
+    d_carrier_scale.reserve(d_active_carriers);
+    for (const auto &run : d_compensation_runs) {
+        for (unsigned int i_c = run.carrier; i_c < run.carrier + run.length; i_c++)
+            d_carrier_scale.push_back(c_window[fftshift(i_c, n)] * norm * input_scale);
+    }
+
+    for (const auto &point : ofdm_params->constellation())
+        d_reciprocals.push_back(1.0f / point);
+
+    for (unsigned int i = 0; i < d_workers.size(); i++) {
+        d_compensation_scratch.emplace_back(d_active_carriers);
+        d_index_scratch.emplace_back(n);
+    }
 
-    for (unsigned int i = 0; i < s_window.size(); i++)
-        this->d_window_symbols[i] = s_window[i] * norm;
+    // Every symbol's indices are generated independently, so the table of all
+    // waveforms is filled by all workers
+    const size_t table_symbols = size_t(d_waveforms) * m;
+    if (table_symbols * d_active_carriers <= max_index_table) {
+        d_tx_indices.resize(table_symbols * d_active_carriers);
+        d_workers.run(table_symbols, [this, m](unsigned int i, unsigned int worker) {
+            generate_active_indices(i / m,
+                                    i % m,
+                                    &d_tx_indices[i * d_active_carriers],
+                                    d_index_scratch[worker].data());
+        });
+    }
+
+    // The periodogram normalisation is folded into the symbol window
+    for (unsigned int i = 0; i < s_window.size(); i++) {
+        this->d_window_symbols[i] = s_window[i] * norm / (m * n);
+        d_window_sum += d_window_symbols[i];
+    }
+    for (unsigned int i = 0; i < d_clutter_window.size(); i++)
+        d_clutter_window[i] = -d_window_symbols[i];
 }
 
-ofdmradar_rx_impl::~ofdmradar_rx_impl()
+ofdmradar_rx_impl::~ofdmradar_rx_impl() { stop(); }
+
+bool ofdmradar_rx_impl::start()
 {
-    fftwf_destroy_plan(d_doppler_fft_plan);
-    fftwf_destroy_plan(d_peri_c_ifft_plan);
+    if (pipelined() && !d_doppler_thread.joinable()) {
+        d_stop_pipeline = false;
+        d_doppler_thread = std::thread([this]() { doppler_thread_main(); });
+    }
+
+    return block::start();
+}
+
+bool ofdmradar_rx_impl::stop()
+{
+    if (d_doppler_thread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(d_pipeline_mutex);
+            d_stop_pipeline = true;
+        }
+        d_pipeline_cond.notify_all();
+        d_doppler_thread.join();
+    }
+
+    return block::stop();
 }
 
 void ofdmradar_rx_impl::forecast(int noutput_items, gr_vector_int &nitemsreq)
 {
-    nitemsreq[0] = std::min(0x1000UL, d_buffer_size - d_total_consumed);
+    std::fill(nitemsreq.begin(),
+              nitemsreq.end(),
+              std::min(0x1000UL, d_buffer_size + d_timing_shift - d_total_consumed));
 }
 
-int ofdmradar_rx_impl::general_work(int noutput_items,
-                                    gr_vector_int &ninput_items,
-                                    gr_vector_const_void_star &input_items,
-                                    gr_vector_void_star &output_items)
+void ofdmradar_rx_impl::doppler_thread_main()
+{
+    std::unique_lock<std::mutex> lock(d_pipeline_mutex);
+    for (;;) {
+        d_pipeline_cond.wait(lock, [this]() {
+            return d_stop_pipeline || d_frames_transformed < d_frames_received;
+        });
+        if (d_stop_pipeline)
+            return;
+
+        gr_complex *frame = frame_buffer(d_frames_transformed);
+        lock.unlock();
+
+        transform_doppler(
+            frame, 0, frame, d_ofdm_params->peri_carriers(), *d_doppler_workers);
+        if (integrating())
+            integrate(d_frames_transformed, frame, d_ofdm_params->peri_carriers());
+
+        lock.lock();
+        d_frames_transformed++;
+        d_pipeline_cond.notify_all();
+    }
+}
+
+void ofdmradar_rx_impl::generate_active_indices(unsigned int waveform,
+                                                unsigned int symbol,
+                                                uint8_t *out,
+                                                uint8_t *scratch) const
+{
+    generate_tx_indices(scratch, symbol, waveform);
+    // Runs are in ascending carrier order, so out never overtakes them in scratch
+    for (const auto &run : d_compensation_runs)
+        out = std::copy_n(&scratch[run.carrier], run.length, out);
+}
+
+const gr_complex *ofdmradar_rx_impl::compensation(unsigned int symbol,
+                                                  unsigned int worker)
+{
+    const uint8_t *indices;
+    if (!d_tx_indices.empty()) {
+        const size_t row = size_t(d_waveform) * d_ofdm_params->symbols() + symbol;
+        indices = &d_tx_indices[row * d_active_carriers];
+    } else {
+        uint8_t *scratch = d_index_scratch[worker].data();
+        generate_active_indices(d_waveform, symbol, scratch, scratch);
+        indices = scratch;
+    }
+
+    gr_complex *comp = d_compensation_scratch[worker].data();
+    for (size_t i = 0; i < d_active_carriers; i++)
+        comp[i] = d_reciprocals[indices[i]] * d_carrier_scale[i];
+    return comp;
+}
+
+void ofdmradar_rx_impl::process_range_batch(unsigned int channel,
+                                            unsigned int first_symbol,
+                                            gr_complex *frame,
+                                            unsigned int worker)
 {
-    const gr_complex *const in = reinterpret_cast<const gr_complex *>(input_items[0]);
-    gr_complex *const out = reinterpret_cast<gr_complex *>(output_items[0]);
     const auto n = d_ofdm_params->carriers();
+    const auto peri_n = d_ofdm_params->peri_carriers();
+    const auto m = d_ofdm_params->symbols();
+    const auto count = std::min(d_range_batch, m - first_symbol);
+    const bool full = count == d_range_batch;
+    const size_t batch = channel * batches() + first_symbol / d_range_batch;
+    const gr_complex *input = d_batch_inputs[batch];
+
+    gr_complex *const symbols = &d_symbol_buffer[(channel * m + first_symbol) * n];
+    gr_complex *const rows =
+        &frame[channel * d_ofdm_params->peri_length() + first_symbol * peri_n];
+
+    // Timing tracking sums up the phase slope of the channel estimates
+    const bool track = !d_batch_slopes.empty();
+    gr_complex slope = 0;
+
+    if (input)
+        (full ? d_range_direct_fft : d_range_direct_tail_fft)->execute(input, symbols);
+    else
+        (full ? d_range_fft : d_range_tail_fft)->execute(symbols, symbols);
+
+    const auto &czt = full ? d_range_czt : d_range_tail_czt;
+    if (czt) {
+        // Divide out TX symbols in place, inactive carriers are zeroed
+        for (unsigned int i = 0; i < count; i++) {
+            const gr_complex *comp = compensation(first_symbol + i, worker);
+            gr_complex *spectrum = &symbols[i * n];
+
+            unsigned int end = 0;
+            for (const auto &run : d_compensation_runs) {
+                std::fill(&spectrum[end], &spectrum[run.carrier], 0);
+                volk_32fc_x2_multiply_32fc(
+                    &spectrum[run.carrier], &spectrum[run.carrier], comp, run.length);
+                if (track)
+                    slope += frame_sync::phase_slope(&spectrum[run.carrier], run.length);
+                comp += run.length;
+                end = run.carrier + run.length;
+            }
+            std::fill(&spectrum[end], &spectrum[n], 0);
+        }
+        if (track)
+            d_batch_slopes[batch] = slope;
+
+        // Channel response at the zoomed range bins only
+        czt->execute(symbols, d_range_scratch[worker].data(), rows, peri_n);
+        return;
+    }
+
+    // Divide out TX symbols, zero-padding every symbol to the periodogram width
+    for (unsigned int i = 0; i < count; i++) {
+        const gr_complex *spectrum = &symbols[i * n];
+        const gr_complex *comp = compensation(first_symbol + i, worker);
+        gr_complex *row = &rows[i * peri_n];
+
+        std::fill_n(row, peri_n, 0);
+        for (const auto &run : d_compensation_runs) {
+            volk_32fc_x2_multiply_32fc(
+                &row[run.bin], &spectrum[run.carrier], comp, run.length);
+            if (track)
+                slope += frame_sync::phase_slope(&row[run.bin], run.length);
+            comp += run.length;
+        }
+    }
+    if (track)
+        d_batch_slopes[batch] = slope;
+
+    // Transform back to obtain channel response
+    (full ? d_peri_c_ifft : d_peri_c_tail_ifft)->execute(rows, rows);
+}
+
+void ofdmradar_rx_impl::transform_doppler(const gr_complex *frame,
+                                          unsigned int first_row,
+                                          gr_complex *periodogram,
+                                          unsigned int stride,
+                                          worker_pool &workers)
+{
+    const auto roi_n = d_ofdm_params->roi_carriers();
+    const unsigned int tiles = (roi_n + doppler_tile_width - 1) / doppler_tile_width;
+
+    // Transform to doppler domain along symbol axis, for range bins in the ROI only
+    workers.run(
+        tiles * d_channels,
+        [this, frame, first_row, periodogram, stride, tiles](unsigned int job,
+                                                             unsigned int worker) {
+            transform_doppler_tile(job / tiles,
+                                   frame,
+                                   first_row,
+                                   periodogram,
+                                   stride,
+                                   job % tiles * doppler_tile_width,
+                                   d_doppler_tiles[worker].data(),
+                                   suppressing_clutter()
+                                       ? d_clutter_scratch[worker].data()
+                                       : nullptr);
+        });
+
+    d_clutter_valid = true;
+}
+
+void ofdmradar_rx_impl::transform_doppler_tile(unsigned int channel,
+                                               const gr_complex *frame,
+                                               unsigned int first_row,
+                                               gr_complex *periodogram,
+                                               unsigned int stride,
+                                               unsigned int first_carrier,
+                                               gr_complex *tile,
+                                               gr_complex *clutter_scratch)
+{
+    frame += channel * d_ofdm_params->peri_length();
+    periodogram += channel * d_ofdm_params->peri_length();
+    gr_complex *const clutter_map =
+        suppressing_clutter() ? &d_clutter_map[channel * d_ofdm_params->roi_carriers()]
+                              : nullptr;
+
     const auto peri_n = d_ofdm_params->peri_carriers();
     const auto m = d_ofdm_params->symbols();
     const auto peri_m = d_ofdm_params->peri_symbols();
-    const auto cpl = d_ofdm_params->cyclic_prefix_length();
-    const int in_items = ninput_items[0];
+    const auto roi_m = d_ofdm_params->roi_symbols();
+    const auto width =
+        std::min(doppler_tile_width, d_ofdm_params->roi_carriers() - first_carrier);
+    const bool full = width == doppler_tile_width;
+    const auto symbol_row = [first_row, m](unsigned int i_s) {
+        return first_row + i_s < m ? first_row + i_s : first_row + i_s - m;
+    };
 
-    int consumed = 0;
+    const auto &pruned = full ? d_doppler_pruned_fft : d_doppler_pruned_tail_fft;
+    const auto &czt = full ? d_doppler_czt : d_doppler_tail_czt;
+    if (pruned || czt) {
+        // Columns are packed without their zero padding
+        for (unsigned int i_s = 0; i_s < m; i_s++) {
+            const gr_complex *row = &frame[symbol_row(i_s) * peri_n + first_carrier];
+            const float w = d_window_symbols[i_s];
+            for (unsigned int i = 0; i < width; i++)
+                tile[i * m + i_s] = row[i] * w;
+        }
+    }
+
+    if ((pruned || czt) && suppressing_clutter())
+        suppress_clutter(clutter_map, tile, clutter_scratch, m, first_carrier, width);
 
-    for (; d_symbol_idx < m; d_symbol_idx++) {
-        if (in_items - consumed < n + cpl) {
-            // Not enough samples the next fft
-            consume(0, consumed);
-            return 0;
+    gr_complex *spectrum = &tile[doppler_tile_width * m];
+    if (czt) {
+        czt->execute(tile, spectrum, spectrum, czt->length());
+
+        for (unsigned int j = 0; j < roi_m; j++) {
+            gr_complex *row =
+                &periodogram[zoom_doppler_row(j, roi_m) * stride + first_carrier];
+            for (unsigned int i = 0; i < width; i++)
+                row[i] = spectrum[i * czt->length() + j];
         }
+        return;
+    }
 
-        std::memcpy(d_fft_gr_in, &in[consumed + cpl / 2], sizeof(gr_complex) * n);
-        consumed += n + cpl;
-        d_total_consumed += n + cpl;
+    if (pruned) {
+        for (unsigned int r = 0; r < d_doppler_outputs.size(); r++) {
+            if (d_doppler_outputs[r].empty())
+                continue;
 
-        fftwf_execute(d_fft_plan);
+            pruned->execute(tile, spectrum, r);
 
-        std::memset(d_fft_in, 0, sizeof(gr_complex) * peri_n);
-        // Divide out TX symbols
-        for (int i_c = 0; i_c < n; i_c++) {
-            unsigned int idx = pad_spectrum(i_c, n, peri_n);
-            if (d_ofdm_params->carrier_mask()[i_c])
-                d_fft_gr_in[idx] = d_window_carriers[i_c] * d_fft_gr_out[i_c] /
-                                   d_tx_symbols[d_symbol_idx * n + i_c];
-            else
-                d_fft_gr_in[idx] = 0;
+            for (const auto &output : d_doppler_outputs[r]) {
+                gr_complex *row = &periodogram[output.first * stride + first_carrier];
+                for (unsigned int i = 0; i < width; i++)
+                    row[i] = spectrum[i * m + output.second];
+            }
         }
+        return;
+    }
 
-        // Transform back to obtain channel response
-        fftwf_execute(d_peri_c_ifft_plan);
+    const auto &fft = full ? d_doppler_fft : d_doppler_tail_fft;
 
-        // Store in heap buffer
-        std::memcpy(&d_frame_buffer[d_symbol_idx * peri_n],
-                    d_fft_gr_out,
-                    sizeof(gr_complex) * peri_n);
+    // Transpose the columns into the tile, windowing and normalising on the way
+    for (unsigned int i_s = 0; i_s < m; i_s++) {
+        const gr_complex *row = &frame[symbol_row(i_s) * peri_n + first_carrier];
+        const float w = d_window_symbols[i_s];
+        for (unsigned int i = 0; i < width; i++)
+            tile[i * peri_m + i_s] = row[i] * w;
     }
-    consume(0, consumed);
+    for (unsigned int i = 0; i < width; i++)
+        std::fill_n(&tile[i * peri_m + m], peri_m - m, 0);
 
-    // Transform to doppler domain along symbol axis
-    for (; d_carrier_idx < peri_n; d_carrier_idx++) {
-        std::memset(d_fft_in, 0, sizeof(gr_complex) * peri_m);
-        for (int i_s = 0; i_s < m; i_s++)
-            d_fft_gr_in[i_s] =
-                d_frame_buffer[i_s * peri_n + d_carrier_idx] * d_window_symbols[i_s];
+    if (suppressing_clutter())
+        suppress_clutter(
+            clutter_map, tile, clutter_scratch, peri_m, first_carrier, width);
 
-        fftwf_execute(d_doppler_fft_plan);
+    fft->execute(tile, tile);
 
-        for (int i_s = 0; i_s < peri_m; i_s++)
-            d_frame_buffer[i_s * peri_n + d_carrier_idx] =
-                d_fft_gr_out[i_s] /
-                static_cast<float>(d_ofdm_params->symbols() * d_ofdm_params->carriers());
+    // Every tile has read its columns already, so this may overwrite the frame
+    for (unsigned int i_r = 0; i_r < roi_m; i_r++) {
+        const unsigned int i_s = roi_doppler_bin(i_r, roi_m, peri_m);
+        gr_complex *row = &periodogram[i_r * stride + first_carrier];
+        for (unsigned int i = 0; i < width; i++)
+            row[i] = tile[i * peri_m + i_s];
     }
+}
 
-    int produced = 0;
-    for (; d_wr_symbol_idx < peri_m; d_wr_symbol_idx++) {
-        if (noutput_items - produced < peri_n)
-            return produced;
+void ofdmradar_rx_impl::suppress_clutter(gr_complex *clutter_map,
+                                         gr_complex *tile,
+                                         gr_complex *scratch,
+                                         unsigned int dist,
+                                         unsigned int first_carrier,
+                                         unsigned int width)
+{
+    const auto m = d_ofdm_params->symbols();
+
+    for (unsigned int i = 0; i < width; i++) {
+        gr_complex *column = &tile[i * dist];
+
+        // Subtracting the windowed mean with the window applied zeroes the sum over
+        // the column, i.e. the zero doppler bin
+        gr_complex sum;
+        volk_32fc_32f_dot_prod_32fc(&sum, column, d_clutter_ones.data(), m);
+        const gr_complex mean = sum / d_window_sum;
+
+        gr_complex &background = clutter_map[first_carrier + i];
+        if (d_clutter_alpha > 0)
+            background =
+                d_clutter_valid ? background + d_clutter_alpha * (mean - background)
+                                : mean;
+
+        const gr_complex clutter = d_notch ? mean : background;
+        volk_32fc_s32fc_multiply_32fc(scratch, d_clutter_window.data(), clutter, m);
+        volk_32fc_x2_add_32fc(column, column, scratch, m);
+    }
+}
+
+void ofdmradar_rx_impl::integrate(uint64_t frame,
+                                  const gr_complex *periodogram,
+                                  unsigned int stride)
+{
+    const auto roi_n = d_ofdm_params->roi_carriers();
+    const auto roi_m = d_ofdm_params->roi_symbols();
+    const auto peri_length = d_ofdm_params->peri_length();
+    const float weight = 1.0f / d_integration;
+    // The first frame starts a block average, or the moving average for good
+    const bool first = d_exponential ? frame == 0 : frame % d_integration == 0;
+
+    for (unsigned int i = 0; i < d_channels * roi_m; i++) {
+        const unsigned int ch = i / roi_m, i_r = i % roi_m;
+        float *sum = &d_integration_sum[i * roi_n];
+        float *power = d_row_power.data();
+        volk_32fc_magnitude_squared_32f(
+            power, &periodogram[ch * peri_length + i_r * stride], roi_n);
+
+        if (first) {
+            std::copy_n(power, roi_n, sum);
+        } else if (d_exponential) {
+            volk_32f_s32f_multiply_32f(sum, sum, 1 - weight, roi_n);
+            volk_32f_s32f_multiply_32f(power, power, weight, roi_n);
+            volk_32f_x2_add_32f(sum, sum, power, roi_n);
+        } else {
+            volk_32f_x2_add_32f(sum, sum, power, roi_n);
+        }
+    }
+
+    if (!integrated(frame))
+        return;
+
+    volk_32f_s32f_multiply_32f(d_power_maps[frame % d_power_maps.size()].data(),
+                               d_integration_sum.data(),
+                               d_exponential ? 1 : weight,
+                               d_integration_sum.size());
+}
+
+void ofdmradar_rx_impl::finish_buffer()
+{
+    d_symbol_idx = 0;
+    d_range_idx = 0;
+    d_total_consumed = 0;
+    d_timing_shift = 0;
+    d_waveform = (d_waveform + 1) % d_waveforms;
 
-        std::memcpy(&out[produced],
-                    &d_frame_buffer[d_wr_symbol_idx * peri_n],
-                    sizeof(gr_complex) * peri_n);
+    // The ring keeps the symbols for the next CPIs
+    if (sliding())
+        return;
 
-        produced += peri_n;
+    d_cpi_remaining = d_ofdm_params->symbols();
+    {
+        std::lock_guard<std::mutex> lock(d_pipeline_mutex);
+        d_frames_received++;
     }
+    d_pipeline_cond.notify_all();
+}
 
-    while (d_total_consumed < d_buffer_size) {
-        if (in_items - consumed == 0)
-            return produced; // Need more input
+void ofdmradar_rx_impl::resync()
+{
+    // The previous buffer merely ended early, its frame is complete
+    if (d_range_idx == d_ofdm_params->symbols()) {
+        finish_buffer();
+        return;
+    }
 
-        // Consume remaining items
-        consume(0, in_items - consumed);
-        d_total_consumed += in_items - consumed;
-        consumed = in_items;
+    if (d_total_consumed > 0) {
+        d_frames_dropped++;
+        d_waveform = (d_waveform + 1) % d_waveforms;
+        GR_LOG_WARN(d_logger,
+                    boost::format("Dropped partial frame after %u samples, "
+                                  "resynchronising on a new buffer") %
+                        d_total_consumed);
     }
 
+    // Sliding CPIs must not combine symbols from both sides of the gap either
     d_symbol_idx = 0;
-    d_carrier_idx = 0;
-    d_wr_symbol_idx = 0;
+    d_range_idx = 0;
     d_total_consumed = 0;
+    d_cpi_remaining = d_ofdm_params->symbols();
+}
+
+void ofdmradar_rx_impl::select_waveform(uint64_t offset)
+{
+    get_tags_in_range(d_waveform_tags, 0, offset, offset + 1, d_waveform_tag_key);
+    for (const auto &tag : d_waveform_tags) {
+        if (pmt::is_integer(tag.value) && pmt::to_long(tag.value) >= 0)
+            d_waveform = pmt::to_long(tag.value) % d_waveforms;
+    }
+}
+
+template <typename T>
+int ofdmradar_rx_impl::receive_frame(const gr_vector_const_void_star &input_items,
+                                     int start,
+                                     int nitems,
+                                     uint64_t offset)
+{
+    // Timing and tags are taken from the first channel
+    const T *in = &static_cast<const T *>(input_items[0])[start];
+    const auto n = d_ofdm_params->carriers();
+    const auto m = d_ofdm_params->symbols();
+    const auto cpl = d_ofdm_params->cyclic_prefix_length();
+
+    const auto symbol_length = d_ofdm_params->symbol_length();
+
+    int consumed = 0;
+
+    // Acquire the frame timing first, then skip ahead to the next frame start
+    if (d_sync && !d_sync->acquired()) {
+        const int used = d_sync->buffer(in, nitems);
+        if (d_sync->acquired()) {
+            d_sync_skip = d_sync->next_frame();
+            GR_LOG_INFO(d_logger,
+                        boost::format("Acquired frame timing, first frame starts at "
+                                      "sample %u") %
+                            (offset + used + d_sync_skip));
+        }
+        return used;
+    }
+
+    if (d_sync_skip > 0) {
+        const size_t skip = std::min<size_t>(d_sync_skip, nitems);
+        d_sync_skip -= skip;
+        return skip;
+    }
+
+    // Input is only used up to the next buffer start, so a buffer that starts before
+    // the current one is complete is noticed right at its first sample
+    if (d_use_tags) {
+        get_tags_in_range(d_tags, 0, offset, offset + nitems, d_len_tag_key);
+        std::sort(d_tags.begin(), d_tags.end(), tag_t::offset_compare);
+
+        for (const auto &tag : d_tags) {
+            // Shorter packets cannot hold a frame, so they do not mark one
+            if (!pmt::is_integer(tag.value) ||
+                pmt::to_long(tag.value) < d_ofdm_params->frame_length())
+                continue;
+
+            if (tag.offset > offset) {
+                nitems = tag.offset - offset;
+
+                // Skip straight to the next buffer if the frame cannot be completed
+                if (d_range_idx < m &&
+                    d_total_consumed + nitems < d_ofdm_params->frame_length()) {
+                    resync();
+                    return nitems;
+                }
+                break;
+            }
+
+            if (d_total_consumed > 0)
+                resync();
+            d_buffer_size = pmt::to_long(tag.value);
+            if (d_waveforms > 1)
+                select_waveform(tag.offset);
+        }
+    }
+
+    const bool receiving = d_symbol_idx < m;
+
+    while (d_symbol_idx < m && d_cpi_remaining > 0) {
+        const size_t batch = d_symbol_idx / d_range_batch;
+        const size_t count = std::min<size_t>(d_range_batch, m - d_symbol_idx);
+        const auto &direct =
+            count == d_range_batch ? d_range_direct_fft : d_range_direct_tail_fft;
+        const size_t first = start + consumed + cpl / 2;
+        const auto symbol = [&input_items, first](unsigned int ch) {
+            return &static_cast<const T *>(input_items[ch])[first];
+        };
+        const auto buffer = [this, n, m](unsigned int ch, size_t i_s) {
+            return &d_symbol_buffer[(ch * m + i_s) * n];
+        };
+
+        // Batches that are completely available get transformed from the input
+        // buffer in place, provided its alignment suits the plan. Channels whose
+        // buffers do not suit it are copied.
+        if (direct_input(symbol(0)) && d_symbol_idx % d_range_batch == 0 &&
+            nitems - consumed >= count * symbol_length &&
+            direct->can_execute(direct_input(symbol(0)), buffer(0, d_symbol_idx))) {
+            for (unsigned int ch = 0; ch < d_channels; ch++) {
+                const gr_complex *symbols = direct_input(symbol(ch));
+                if (direct->can_execute(symbols, buffer(ch, d_symbol_idx))) {
+                    d_batch_inputs[ch * batches() + batch] = symbols;
+                    continue;
+                }
+
+                for (size_t i = 0; i < count; i++)
+                    load_symbol(buffer(ch, d_symbol_idx + i),
+                                symbol(ch) + i * symbol_length,
+                                n);
+                d_batch_inputs[ch * batches() + batch] = nullptr;
+            }
+            d_symbol_idx += count;
+            d_cpi_remaining -= count;
+            consumed += count * symbol_length;
+            d_total_consumed += count * symbol_length;
+            continue;
+        }
+
+        if (nitems - consumed < symbol_length)
+            break;
+
+        for (unsigned int ch = 0; ch < d_channels; ch++) {
+            load_symbol(buffer(ch, d_symbol_idx), symbol(ch), n);
+            d_batch_inputs[ch * batches() + batch] = nullptr;
+        }
+        d_symbol_idx++;
+        d_cpi_remaining--;
+        consumed += symbol_length;
+        d_total_consumed += symbol_length;
+    }
+
+    // Range process all batches that are complete by now
+    const size_t complete =
+        d_symbol_idx == m ? m : d_symbol_idx / d_range_batch * d_range_batch;
+    if (complete > d_range_idx) {
+        const unsigned int first = d_range_idx;
+        const unsigned int jobs = (complete - first + d_range_batch - 1) / d_range_batch;
+        gr_complex *frame = frame_buffer(d_frames_received);
+
+        d_workers.run(jobs * d_channels,
+                      [this, first, jobs, frame](unsigned int job, unsigned int worker) {
+                          process_range_batch(job / jobs,
+                                              first + job % jobs * d_range_batch,
+                                              frame,
+                                              worker);
+                      });
+        d_range_idx = complete;
+    }
+
+    // The timing correction moves the end of this buffer. If the next frame starts
+    // early, it overlaps the last symbol, which was received in this call as a whole.
+    if (d_sync && receiving && d_range_idx == m) {
+        gr_complex slope = 0;
+        for (const auto &batch_slope : d_batch_slopes)
+            slope += batch_slope;
+
+        d_timing_shift = d_sync->correction(slope);
+        if (d_timing_shift)
+            GR_LOG_DEBUG(d_logger,
+                         boost::format("Corrected frame timing by %d samples") %
+                             d_timing_shift);
+
+        const size_t buffer_end = d_buffer_size + d_timing_shift;
+        if (d_total_consumed > buffer_end) {
+            consumed -= d_total_consumed - buffer_end;
+            d_total_consumed = buffer_end;
+        }
+    }
+
+    // Sliding CPIs end on a batch boundary, once their last symbol is range processed
+    if (sliding() && d_cpi_remaining == 0 && d_range_idx == d_symbol_idx) {
+        d_cpi_first_row = d_symbol_idx % m;
+        d_cpi_remaining = d_hop;
+
+        {
+            std::lock_guard<std::mutex> lock(d_pipeline_mutex);
+            d_frames_received++;
+        }
+        d_pipeline_cond.notify_all();
+
+        return consumed;
+    }
+
+    if (d_range_idx < m)
+        return consumed;
+
+    // Skip the remainder of the receive buffer
+    const size_t buffer_end = d_buffer_size + d_timing_shift;
+    if (d_total_consumed < buffer_end) {
+        const size_t skip =
+            std::min<size_t>(buffer_end - d_total_consumed, nitems - consumed);
+        consumed += skip;
+        d_total_consumed += skip;
+
+        if (d_total_consumed < buffer_end)
+            return consumed; // Need more input
+    }
+
+    finish_buffer();
+    return consumed;
+}
+
+int ofdmradar_rx_impl::general_work(int noutput_items,
+                                    gr_vector_int &ninput_items,
+                                    gr_vector_const_void_star &input_items,
+                                    gr_vector_void_star &output_items)
+{
+    gr_complex *const out = reinterpret_cast<gr_complex *>(output_items[0]);
+    float *const power_out = reinterpret_cast<float *>(output_items[0]);
+    const auto peri_n = d_ofdm_params->peri_carriers();
+    const auto peri_length = d_ofdm_params->peri_length();
+    const auto roi_length = d_ofdm_params->roi_length();
+    const auto roi_n = d_ofdm_params->roi_carriers();
+    const auto roi_m = d_ofdm_params->roi_symbols();
+    const int in_items = *std::min_element(ninput_items.begin(), ninput_items.end());
+
+    int consumed = 0;
+    int produced = 0;
+
+    for (;;) {
+        bool progress = false;
+
+        // Without pipelining, the doppler stage runs here. If the whole periodogram
+        // of a single channel fits, it is written straight to the output buffer.
+        // Sliding CPIs must not overwrite the ring, so they are kept in a separate
+        // buffer otherwise.
+        if (!pipelined() && d_frames_transformed < d_frames_received) {
+            gr_complex *frame = frame_buffer(d_frames_transformed);
+
+            if (!integrating() && d_channels == 1 &&
+                noutput_items - produced >= (int)d_out_size) {
+                transform_doppler(
+                    frame, d_cpi_first_row, &out[produced], roi_n, d_workers);
+                produced += d_out_size;
+                d_frames_drained++;
+            } else {
+                transform_doppler(frame,
+                                  d_cpi_first_row,
+                                  sliding() ? d_sliding_periodogram.data() : frame,
+                                  peri_n,
+                                  d_workers);
+                if (integrating())
+                    integrate(d_frames_transformed,
+                              periodogram_buffer(d_frames_transformed),
+                              peri_n);
+            }
+            d_frames_transformed++;
+            progress = true;
+        }
+
+        uint64_t transformed;
+        {
+            std::lock_guard<std::mutex> lock(d_pipeline_mutex);
+            transformed = d_frames_transformed;
+        }
+
+        // Drain the oldest finished periodogram, or power map when integrating. Frames
+        // within an integration period have no output of their own.
+        if (d_frames_drained < transformed && integrating() &&
+            !integrated(d_frames_drained)) {
+            d_frames_drained++;
+            progress = true;
+        } else if (d_frames_drained < transformed) {
+            const gr_complex *periodogram = periodogram_buffer(d_frames_drained);
+            const float *power = integrating() ? power_map(d_frames_drained) : nullptr;
+
+            for (; d_wr_symbol_idx < roi_m && noutput_items - produced >= roi_n;
+                 d_wr_symbol_idx++) {
+                if (power)
+                    interleave(&power_out[produced * d_channels],
+                               &power[d_wr_symbol_idx * roi_n],
+                               d_channels,
+                               roi_length,
+                               roi_n);
+                else
+                    interleave(&out[produced * d_channels],
+                               &periodogram[d_wr_symbol_idx * peri_n],
+                               d_channels,
+                               peri_length,
+                               roi_n);
+                produced += roi_n;
+                progress = true;
+            }
+
+            if (d_wr_symbol_idx == roi_m) {
+                d_wr_symbol_idx = 0;
+                d_frames_drained++;
+            }
+        }
+
+        // Receive into the next frame buffer, as long as one is free
+        if (d_frames_received - d_frames_drained < d_frame_buffers.size()) {
+            const int nitems = in_items - consumed;
+            const uint64_t offset = nitems_read(0) + consumed;
+            const int used =
+                d_format == sample_format::SC16
+                    ? receive_frame<lv_16sc_t>(input_items, consumed, nitems, offset)
+                    : receive_frame<gr_complex>(input_items, consumed, nitems, offset);
+            consumed += used;
+            progress |= used > 0;
+        }
+
+        if (progress)
+            continue;
+
+        // Nothing left to do but wait for the doppler thread
+        if (d_frames_drained == d_frames_received || noutput_items - produced < roi_n)
+            break;
+
+        std::unique_lock<std::mutex> lock(d_pipeline_mutex);
+        d_pipeline_cond.wait(lock, [this]() {
+            return d_stop_pipeline || d_frames_transformed > d_frames_drained;
+        });
+        if (d_stop_pipeline)
+            break;
+    }
+
+    consume_each(consumed);
     return produced;
 }
 
@@ -8,11 +8,24 @@
 #ifndef INCLUDED_OFDMRADAR_OFDMRADAR_RX_IMPL_H
 #define INCLUDED_OFDMRADAR_OFDMRADAR_RX_IMPL_H
 
+#include "batched_fft.h"
+#include "chirp_z.h"
+#include "frame_sync.h"
 #include "ofdmradar_impl.h"
+#include "pruned_fft.h"
+#include "worker_pool.h"
 
 #include <ofdmradar/ofdmradar_rx.h>
 
 #include <pmt/pmt.h>
+#include <volk/volk_alloc.hh>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
 
 namespace gr {
 namespace ofdmradar {
@@ -20,27 +33,285 @@ namespace ofdmradar {
 class ofdmradar_rx_impl : public ofdmradar_rx, ofdmradar_shared
 {
 private:
+    /*!
+     * Active carriers that are adjacent both in the spectrum and in the zero-padded
+     * periodogram row, compensated with a single vector multiply
+     */
+    struct compensation_run {
+        unsigned int carrier;
+        unsigned int bin;
+        unsigned int length;
+    };
+
+    // Channels are received in lockstep and share everything but their buffers. Each
+    // frame buffer, the symbol buffer, the batch inputs and slopes, the clutter map and
+    // the integration hold one block per channel, channel after channel.
+    unsigned int d_channels;
+    // The TX may cycle through a bank of d_waveforms frames. Its frames are counted in
+    // d_waveform, unless their first sample is tagged with their index.
+    unsigned int d_waveforms;
+    unsigned int d_waveform = 0;
     pmt::pmt_t d_len_tag_key;
+    pmt::pmt_t d_waveform_tag_key;
+    bool d_use_tags;
     size_t d_out_size;
-    std::vector<gr_complex> d_tx_symbols;
     size_t d_symbol_idx = 0;
+    size_t d_range_idx = 0;
     size_t d_wr_symbol_idx = 0;
-    size_t d_carrier_idx = 0;
-    std::vector<gr_complex> d_frame_buffer;
+    volk::vector<gr_complex> d_symbol_buffer;
+    std::vector<volk::vector<gr_complex>> d_frame_buffers;
+    std::vector<volk::vector<gr_complex>> d_doppler_tiles;
     std::vector<tag_t> d_tags;
-    fftwf_plan d_doppler_fft_plan;
-    fftwf_plan d_peri_c_ifft_plan;
-    size_t d_buffer_size;
+    std::vector<tag_t> d_waveform_tags;
+    // Input buffer location of every range batch, nullptr if it was copied to
+    // d_symbol_buffer. Only valid during the work call that completes the batch.
+    std::vector<const gr_complex *> d_batch_inputs;
+    // Phase slope of the channel estimates of every range batch, if tracking
+    std::vector<gr_complex> d_batch_slopes;
+    std::unique_ptr<batched_fft> d_range_fft;
+    std::unique_ptr<batched_fft> d_range_tail_fft;
+    std::unique_ptr<batched_fft> d_range_direct_fft;
+    std::unique_ptr<batched_fft> d_range_direct_tail_fft;
+    std::unique_ptr<batched_fft> d_peri_c_ifft;
+    std::unique_ptr<batched_fft> d_peri_c_tail_ifft;
+    std::unique_ptr<batched_fft> d_doppler_fft;
+    std::unique_ptr<batched_fft> d_doppler_tail_fft;
+    // Used instead of the above for long, zero-padded doppler transforms
+    std::unique_ptr<pruned_fft> d_doppler_pruned_fft;
+    std::unique_ptr<pruned_fft> d_doppler_pruned_tail_fft;
+    // ROI row and pruned transform output index for every doppler bin residue
+    std::vector<std::vector<std::pair<unsigned int, unsigned int>>> d_doppler_outputs;
+    // Used instead of the periodogram transforms when the output grid is zoomed
+    std::unique_ptr<chirp_z> d_range_czt;
+    std::unique_ptr<chirp_z> d_range_tail_czt;
+    std::unique_ptr<chirp_z> d_doppler_czt;
+    std::unique_ptr<chirp_z> d_doppler_tail_czt;
+    std::vector<volk::vector<gr_complex>> d_range_scratch;
+    unsigned int d_range_batch; // Symbols range processed together
+    size_t d_buffer_size; // Follows the length tags, if there are any
     size_t d_total_consumed = 0;
-    std::vector<float> d_window_carriers;
+    std::vector<compensation_run> d_compensation_runs;
+    size_t d_active_carriers = 0;
+    // The TX symbols are kept as the constellation indices of the active carriers, for
+    // all symbols of every waveform. The compensation of a symbol is its carrier scale
+    // (window and input scale) times the reciprocals of its constellation points.
+    // Every worker gathers it into its d_compensation_scratch. The index table is left
+    // empty for huge frames, then the indices are regenerated in d_index_scratch when
+    // needed.
+    std::vector<uint8_t> d_tx_indices;
+    std::vector<gr_complex> d_reciprocals;
+    std::vector<float> d_carrier_scale;
+    std::vector<volk::vector<gr_complex>> d_compensation_scratch;
+    std::vector<std::vector<uint8_t>> d_index_scratch;
     std::vector<float> d_window_symbols;
+    worker_pool d_workers;
+
+    // Pipelined mode: frames are counted from the start of the flowgraph and stored
+    // in d_frame_buffers[frame % d_frame_buffers.size()]. A frame is received, then
+    // doppler transformed on d_doppler_thread and finally drained to the output.
+    std::unique_ptr<worker_pool> d_doppler_workers;
+    std::thread d_doppler_thread;
+    std::mutex d_pipeline_mutex;
+    std::condition_variable d_pipeline_cond;
+    bool d_stop_pipeline = false;
+    uint64_t d_frames_received = 0;
+    uint64_t d_frames_transformed = 0;
+    uint64_t d_frames_drained = 0;
+
+    gr_complex *frame_buffer(uint64_t frame)
+    {
+        return d_frame_buffers[frame % d_frame_buffers.size()].data();
+    }
+
+    size_t batches() const { return d_batch_inputs.size() / d_channels; }
+
+    bool pipelined() const { return d_frame_buffers.size() > 1; }
+
+    // Sliding mode: frame buffer 0 is a ring of the last symbols() range processed
+    // symbols, indexed by their position in the frame. A CPI (coherent processing
+    // interval) is output every d_hop symbols, its oldest symbol is in row
+    // d_cpi_first_row. Periodograms that do not fit the output buffer are kept in
+    // d_sliding_periodogram, as they must not overwrite the ring.
+    unsigned int d_hop;
+    unsigned int d_cpi_remaining; // Symbols to receive until the next CPI is complete
+    unsigned int d_cpi_first_row = 0;
+    volk::vector<gr_complex> d_sliding_periodogram;
+
+    bool sliding() const { return d_hop > 0; }
+
+    const gr_complex *periodogram_buffer(uint64_t frame)
+    {
+        return sliding() ? d_sliding_periodogram.data() : frame_buffer(frame);
+    }
+
+    std::atomic<uint64_t> d_frames_dropped{ 0 };
+
+    // Timing acquisition: the frame start is searched for in the received signal and
+    // d_sync_skip samples are skipped up to it. Tracking then moves the end of the
+    // current receive buffer by d_timing_shift samples.
+    std::unique_ptr<frame_sync> d_sync;
+    size_t d_sync_skip = 0;
+    int d_timing_shift = 0;
+
+    // Non-coherent integration: the power of every periodogram is accumulated in
+    // d_integration_sum. Every d_integration frames, the result is stored in the power
+    // map of the frame's buffer and output instead of the periodograms.
+    unsigned int d_integration;
+    bool d_exponential;
+    volk::vector<float> d_integration_sum;
+    volk::vector<float> d_row_power;
+    std::vector<volk::vector<float>> d_power_maps;
+
+    bool integrating() const { return d_integration > 0; }
+
+    bool integrated(uint64_t frame) const { return (frame + 1) % d_integration == 0; }
+
+    const float *power_map(uint64_t frame) const
+    {
+        return d_power_maps[frame % d_power_maps.size()].data();
+    }
+
+    // Clutter suppression: d_clutter_map holds the static background of every range
+    // bin in the region of interest, updated with a weight of d_clutter_alpha per
+    // frame. It is valid once the first frame was transformed. The columns are summed
+    // as dot products with d_clutter_ones, and the clutter is subtracted by adding
+    // d_clutter_window, the negated symbol window, scaled by it in each worker's
+    // d_clutter_scratch.
+    float d_clutter_alpha;
+    bool d_notch;
+    bool d_clutter_valid = false;
+    float d_window_sum = 0;
+    volk::vector<gr_complex> d_clutter_map;
+    volk::vector<float> d_clutter_ones;
+    volk::vector<gr_complex> d_clutter_window;
+    std::vector<volk::vector<gr_complex>> d_clutter_scratch;
+
+    bool suppressing_clutter() const { return d_clutter_alpha > 0 || d_notch; }
+
+    /*!
+     * Subtracts the clutter from width windowed columns of a doppler tile, which are
+     * dist elements apart and belong to the range bins starting at first_carrier, using
+     * the clutter map of their channel and symbols() elements of scratch
+     */
+    void suppress_clutter(gr_complex *clutter_map,
+                          gr_complex *tile,
+                          gr_complex *scratch,
+                          unsigned int dist,
+                          unsigned int first_carrier,
+                          unsigned int width);
+
+    /*!
+     * Adds the power of the region of interest of a frame's periodogram, with rows of
+     * the given stride and peri_length() elements per channel, to the integration
+     */
+    void integrate(uint64_t frame, const gr_complex *periodogram, unsigned int stride);
+
+    sample_format d_format;
+
+    /*!
+     * Collects the symbols of the frame currently being received and range processes
+     * every completed batch. Input starts at item start of every channel, offset is its
+     * absolute sample index. Returns the number of samples used of each channel.
+     */
+    template <typename T>
+    int receive_frame(const gr_vector_const_void_star &input_items,
+                      int start,
+                      int nitems,
+                      uint64_t offset);
+
+    /*!
+     * Ends the current receive buffer, handing its frame on to the doppler stage
+     */
+    void finish_buffer();
+
+    /*!
+     * Starts over at a buffer that began before the current one was complete, e.g.
+     * after samples were lost. A partially received frame is dropped.
+     */
+    void resync();
+
+    /*!
+     * Selects the waveform named by a tag on the first sample of a buffer, if any
+     */
+    void select_waveform(uint64_t offset);
+
+    /*!
+     * Writes the constellation indices of the active carriers of a symbol of a waveform
+     * to out, generating those of all carriers in scratch first. out may be scratch.
+     */
+    void generate_active_indices(unsigned int waveform,
+                                 unsigned int symbol,
+                                 uint8_t *out,
+                                 uint8_t *scratch) const;
+
+    /*!
+     * Compensation of the active carriers of a symbol of the current waveform,
+     * gathered in the scratch of the given worker
+     */
+    const gr_complex *compensation(unsigned int symbol, unsigned int worker);
+
+    /*!
+     * Range processing of up to d_range_batch symbols of a channel starting at
+     * first_symbol: FFT, division by the TX symbols and the IFFT into the frame
+     * buffer. Runs on the given worker and uses its scratch memory.
+     */
+    void process_range_batch(unsigned int channel,
+                             unsigned int first_symbol,
+                             gr_complex *frame,
+                             unsigned int worker);
+
+    /*!
+     * Runs the doppler stage of a frame on the given worker pool and stores the region
+     * of interest with rows of the given stride. The periodogram may be written back
+     * to the frame or to a separate buffer, with peri_length() elements per channel.
+     * Symbols are taken from the frame rows in order, starting at first_row and
+     * wrapping around.
+     */
+    void transform_doppler(const gr_complex *frame,
+                           unsigned int first_row,
+                           gr_complex *periodogram,
+                           unsigned int stride,
+                           worker_pool &workers);
+
+    /*!
+     * Doppler transforms up to doppler_tile_width range bins starting at
+     * first_carrier. The columns are transposed through tile, so the transform itself
+     * runs on contiguous memory. clutter_scratch holds symbols() elements for the
+     * clutter suppression.
+     */
+    void transform_doppler_tile(unsigned int channel,
+                                const gr_complex *frame,
+                                unsigned int first_row,
+                                gr_complex *periodogram,
+                                unsigned int stride,
+                                unsigned int first_carrier,
+                                gr_complex *tile,
+                                gr_complex *clutter_scratch);
+
+    void doppler_thread_main();
 
 public:
     ofdmradar_rx_impl(ofdmradar_params::sptr ofdm_params,
                       const std::string &len_tag_key,
-                      size_t buffer_size);
+                      size_t buffer_size,
+                      int nthreads,
+                      int frame_buffers,
+                      int hop,
+                      bool acquire,
+                      sample_format format,
+                      int integration,
+                      bool exponential,
+                      float clutter_alpha,
+                      bool notch,
+                      int channels,
+                      int waveforms);
     ~ofdmradar_rx_impl();
 
+    uint64_t frames_dropped() const override { return d_frames_dropped; }
+
+    bool start() override;
+    bool stop() override;
+
     int general_work(int noutput_items,
                      gr_vector_int &ninput_items,
                      gr_vector_const_void_star &input_items,
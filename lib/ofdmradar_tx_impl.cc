@@ -6,57 +6,157 @@
  */
 
 #include "ofdmradar_tx_impl.h"
+#include "batched_fft.h"
+#include "worker_pool.h"
 
 #include <gnuradio/io_signature.h>
+#include <volk/volk.h>
+#include <volk/volk_alloc.hh>
+#include <boost/format.hpp>
 
 #include <algorithm>
+#include <cmath>
 #include <cstring>
+#include <stdexcept>
+#include <thread>
 
 namespace gr {
 namespace ofdmradar {
 
 ofdmradar_tx::sptr ofdmradar_tx::make(ofdmradar_params::sptr ofdm_params,
-                                      const std::string &len_tag_key)
+                                      const std::string &len_tag_key,
+                                      int waveforms,
+                                      int gap,
+                                      bool burst_tags,
+                                      sample_format format,
+                                      float backoff)
 {
-    return gnuradio::make_block_sptr<ofdmradar_tx_impl>(ofdm_params, len_tag_key);
+    return gnuradio::make_block_sptr<ofdmradar_tx_impl>(
+        ofdm_params, len_tag_key, waveforms, gap, burst_tags, format, backoff);
 }
 
 /*
  * The private constructor
  */
 ofdmradar_tx_impl::ofdmradar_tx_impl(ofdmradar_params::sptr ofdm_params,
-                                     const std::string &len_tag_key)
+                                     const std::string &len_tag_key,
+                                     int waveforms,
+                                     int gap,
+                                     bool burst_tags,
+                                     sample_format format,
+                                     float backoff)
     : gr::sync_block("ofdmradar_tx",
                      gr::io_signature::make(0, 0, 0),
-                     gr::io_signature::make(1, 1, sizeof(gr_complex))),
+                     gr::io_signature::make(1,
+                                            1,
+                                            format == sample_format::SC16
+                                                ? sizeof(lv_16sc_t)
+                                                : sizeof(gr_complex))),
       ofdmradar_shared(ofdm_params),
-      d_frame_buffer(ofdm_params->frame_length()),
-      d_len_tag_key(pmt::intern(len_tag_key))
+      d_len_tag_key(pmt::intern(len_tag_key)),
+      d_waveform_tag_key(pmt::intern("waveform")),
+      d_sob_tag_key(pmt::intern("tx_sob")),
+      d_eob_tag_key(pmt::intern("tx_eob")),
+      d_waveforms(waveforms),
+      d_format(format),
+      d_burst_tags(burst_tags),
+      d_packet_length(ofdm_params->frame_length() + (burst_tags ? 0 : gap))
 {
-    generate_frame(d_frame_buffer.data());
-    set_output_multiple(0x1000);
+    if (waveforms < 1)
+        throw std::runtime_error(boost::str(
+            boost::format("ofdmradar_tx: Invalid number of waveforms (%d)!") %
+            waveforms));
+
+    if (gap < 0)
+        throw std::runtime_error(
+            boost::str(boost::format("ofdmradar_tx: Invalid gap (%d)!") % gap));
+
+    d_frame_buffer.resize(size_t(waveforms) * ofdm_params->frame_length());
+    generate_bank();
+    measure_papr();
+    this->set_output_multiple(d_packet_length);
+
+    if (format == sample_format::SC16) {
+        convert_bank(backoff);
+        GR_LOG_INFO(d_logger,
+                    boost::format("SC16 output with %.1f dB back-off: PAPR %.1f dB, "
+                                  "%u samples clipped") %
+                        backoff % d_papr % d_clipped);
+    }
 }
 
-void ofdmradar_tx_impl::generate_symbol(gr_complex *out)
+void ofdmradar_tx_impl::generate_bank()
 {
-    generate_tx_symbols(d_fft_gr_in);
+    const auto n = d_ofdm_params->carriers();
+    const auto m = d_ofdm_params->symbols();
+    const auto cpl = d_ofdm_params->cyclic_prefix_length();
+    const auto symbol_length = d_ofdm_params->symbol_length();
+
+    worker_pool workers(
+        std::max(1U, std::min(d_waveforms, std::thread::hardware_concurrency())));
+    std::vector<volk::vector<gr_complex>> spectra;
+    std::vector<volk::vector<gr_complex>> symbols;
+    for (unsigned int i = 0; i < workers.size(); i++) {
+        spectra.emplace_back(m * n);
+        symbols.emplace_back(m * n);
+    }
 
-    fftwf_execute(d_ifft_plan);
+    const batched_fft ifft(
+        n, m, 1, n, FFTW_BACKWARD, spectra[0].data(), symbols[0].data(), *d_ofdm_params);
+
+    workers.run(d_waveforms, [&](unsigned int waveform, unsigned int worker) {
+        gr_complex *spectrum = spectra[worker].data();
+        gr_complex *time = symbols[worker].data();
+        for (unsigned int i = 0; i < m; i++)
+            generate_tx_symbols(&spectrum[i * n], i, waveform);
+
+        ifft.execute(spectrum, time);
+
+        // Prepend the cyclic prefix to every symbol
+        gr_complex *frame = &d_frame_buffer[size_t(waveform) * m * symbol_length];
+        for (unsigned int i = 0; i < m; i++) {
+            gr_complex *out = &frame[i * symbol_length];
+            std::copy_n(&time[i * n + n - cpl], cpl, out);
+            std::copy_n(&time[i * n], n, &out[cpl]);
+        }
+    });
+}
 
-    for (unsigned int i = 0;
-         i < d_ofdm_params->carriers() && i < d_ofdm_params->cyclic_prefix_length();
-         i++)
-        out[i] = d_fft_gr_out[d_ofdm_params->carriers() -
-                              d_ofdm_params->cyclic_prefix_length() + i];
-    for (unsigned int i = 0; i < d_ofdm_params->carriers(); i++)
-        out[d_ofdm_params->cyclic_prefix_length() + i] = d_fft_gr_out[i];
+void ofdmradar_tx_impl::measure_papr()
+{
+    float peak = 0;
+    double total = 0;
+    for (const auto &x : d_frame_buffer) {
+        const float power = std::norm(x);
+        peak = std::max(peak, power);
+        total += power;
+    }
+
+    d_papr = total > 0 ? 10 * std::log10(peak * d_frame_buffer.size() / total) : 0;
 }
 
-void ofdmradar_tx_impl::generate_frame(gr_complex *out)
+void ofdmradar_tx_impl::convert_bank(float backoff)
 {
-    // d_generator.seed(d_ofdm_params->seed());
-    for (unsigned int i = 0; i < d_ofdm_params->symbols(); i++)
-        generate_symbol(&out[i * d_ofdm_params->symbol_length()]);
+    float peak = 0;
+    for (const auto &x : d_frame_buffer)
+        peak = std::max({ peak, std::abs(x.real()), std::abs(x.imag()) });
+
+    const float full_scale = 32767;
+    const float scale = peak > 0 ? full_scale * std::pow(10.0f, -backoff / 20) / peak : 0;
+    // A sample is clipped if either component rounds beyond full scale, which the
+    // conversion saturates
+    for (const auto &x : d_frame_buffer) {
+        if (std::abs(x.real()) * scale >= full_scale + 0.5f ||
+            std::abs(x.imag()) * scale >= full_scale + 0.5f)
+            d_clipped++;
+    }
+
+    d_frame_buffer_sc16.resize(d_frame_buffer.size());
+    volk_32f_s32f_convert_16i(reinterpret_cast<int16_t *>(d_frame_buffer_sc16.data()),
+                              reinterpret_cast<const float *>(d_frame_buffer.data()),
+                              scale,
+                              2 * d_frame_buffer.size());
+    std::vector<gr_complex>().swap(d_frame_buffer);
 }
 
 /*
@@ -64,31 +164,66 @@ void ofdmradar_tx_impl::generate_frame(gr_complex *out)
  */
 ofdmradar_tx_impl::~ofdmradar_tx_impl() {}
 
+template <typename T>
+int ofdmradar_tx_impl::output_packets(T *out, const T *bank, int noutput_items)
+{
+    // Every call fills all the space it is given, which holds whole packets
+    const size_t frame_length = d_ofdm_params->frame_length();
+    int produced = 0;
+    while (produced < noutput_items) {
+        const uint64_t offset = nitems_written(0) + produced;
+
+        // Beginning of new packet?
+        if (!d_running_idx) {
+            add_item_tag(0, offset, d_len_tag_key, pmt::from_long(d_packet_length));
+            if (d_waveforms > 1)
+                add_item_tag(0, offset, d_waveform_tag_key, pmt::from_long(d_waveform));
+            if (d_burst_tags)
+                add_item_tag(0, offset, d_sob_tag_key, pmt::PMT_T);
+        }
+
+        int items;
+        if (d_running_idx < frame_length) {
+            items = std::min<size_t>(noutput_items - produced,
+                                     frame_length - d_running_idx);
+            std::memcpy(&out[produced],
+                        &bank[d_waveform * frame_length + d_running_idx],
+                        sizeof(T) * items);
+
+            if (d_burst_tags && d_running_idx + items == frame_length)
+                add_item_tag(0, offset + items - 1, d_eob_tag_key, pmt::PMT_T);
+        } else {
+            items = std::min<size_t>(noutput_items - produced,
+                                     d_packet_length - d_running_idx);
+            std::fill_n(&out[produced], items, T());
+        }
+
+        produced += items;
+        d_running_idx += items;
+        if (d_running_idx == d_packet_length) {
+            d_running_idx = 0;
+            d_waveform = (d_waveform + 1) % d_waveforms;
+        }
+    }
+
+    return produced;
+}
+
 int ofdmradar_tx_impl::work(int noutput_items,
                             gr_vector_const_void_star &input_items,
                             gr_vector_void_star &output_items)
 {
-    gr_complex *out = reinterpret_cast<gr_complex *>(output_items[0]);
-
     if (noutput_items < 0)
         throw std::runtime_error("Negative noutput_items?!");
 
-    int items = std::min<int>(noutput_items, d_frame_buffer.size() - d_running_idx);
-
-    // Beginning of new packet?
-    if (!d_running_idx) {
-        add_item_tag(0,
-                     nitems_written(0),
-                     d_len_tag_key,
-                     pmt::from_long(d_frame_buffer.size()));
-    }
-    std::memcpy(out, &d_frame_buffer[d_running_idx], sizeof(gr_complex) * items);
-
-    d_running_idx += items;
-    if (d_running_idx == d_frame_buffer.size())
-        d_running_idx = 0;
+    if (d_format == sample_format::SC16)
+        return output_packets(static_cast<lv_16sc_t *>(output_items[0]),
+                              d_frame_buffer_sc16.data(),
+                              noutput_items);
 
-    return items;
+    return output_packets(static_cast<gr_complex *>(output_items[0]),
+                          d_frame_buffer.data(),
+                          noutput_items);
 }
 
 } /* namespace ofdmradar */
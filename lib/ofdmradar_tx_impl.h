@@ -13,6 +13,7 @@
 #include <ofdmradar/ofdmradar_tx.h>
 
 #include <pmt/pmt.h>
+#include <volk/volk_complex.h>
 
 #include <vector>
 
@@ -22,16 +23,59 @@ namespace ofdmradar {
 class ofdmradar_tx_impl : public ofdmradar_tx, ofdmradar_shared
 {
     const pmt::pmt_t d_len_tag_key;
+    const pmt::pmt_t d_waveform_tag_key;
+    const pmt::pmt_t d_sob_tag_key;
+    const pmt::pmt_t d_eob_tag_key;
+    unsigned int d_waveforms;
+    unsigned int d_waveform = 0; // Frame of the bank currently sent
+    // The waveform bank, frame after frame. With SC16 output, it is converted to
+    // d_frame_buffer_sc16 and released.
     std::vector<gr_complex> d_frame_buffer;
-    size_t d_running_idx = 0;
+    std::vector<lv_16sc_t> d_frame_buffer_sc16;
+    sample_format d_format;
+    float d_papr;
+    uint64_t d_clipped = 0;
+    // Packets are a frame followed by the idle gap, or a burst of just the frame
+    bool d_burst_tags;
+    size_t d_packet_length;
+    size_t d_running_idx = 0; // Position in the current packet
 
-    void generate_symbol(gr_complex *out);
-    void generate_frame(gr_complex *out);
+    /*!
+     * Generates all frames of the waveform bank in parallel, each with a single
+     * batched IFFT over its symbols
+     */
+    void generate_bank();
+
+    /*!
+     * Measures the peak to average power ratio of the waveform bank
+     */
+    void measure_papr();
+
+    /*!
+     * Converts the waveform bank to SC16, with its peak I or Q component backoff dB
+     * below full scale
+     */
+    void convert_bank(float backoff);
+
+    /*!
+     * Outputs the packets of the given waveform bank, continuing the current one
+     */
+    template <typename T>
+    int output_packets(T *out, const T *bank, int noutput_items);
 
 public:
-    ofdmradar_tx_impl(ofdmradar_params::sptr ofdm_params, const std::string &len_tag_key);
+    ofdmradar_tx_impl(ofdmradar_params::sptr ofdm_params,
+                      const std::string &len_tag_key,
+                      int waveforms,
+                      int gap,
+                      bool burst_tags,
+                      sample_format format,
+                      float backoff);
     ~ofdmradar_tx_impl();
 
+    float papr() const override { return d_papr; }
+    uint64_t clipped_samples() const override { return d_clipped; }
+
     // Where all the action really happens
     int work(int noutput_items,
              gr_vector_const_void_star &input_items,
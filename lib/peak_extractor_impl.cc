@@ -0,0 +1,318 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2021 Analog Devices, Inc.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "peak_extractor_impl.h"
+#include "doppler_rows.h"
+
+#include <gnuradio/io_signature.h>
+#include <boost/format.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace gr {
+namespace ofdmradar {
+
+namespace {
+
+constexpr double speed_of_light = 299792458.0;
+
+constexpr float pi = static_cast<float>(M_PI);
+
+// Bins on either side of the interpolated position used by the sinc interpolation,
+// enough to cover the main lobe of a zero padded and windowed peak
+constexpr int sinc_taps = 8;
+
+// Golden section steps of the sinc maximum search, each shrinking the interval to
+// 0.618 of its size
+constexpr int sinc_search_steps = 20;
+
+/*
+ * Interpolation kernel between bins x apart of a transform of size bins over a
+ * sequence of length nonzero samples centred around center, e.g. (symbols() - 1) / 2
+ * for the doppler FFT. sign is that of the transform's exponent, -1 for a forward
+ * and +1 for a backward one. Summed over all size bins, the kernel reproduces the
+ * transform exactly at any position in between.
+ */
+gr_complex
+dirichlet(float x, unsigned int length, unsigned int size, float center, int sign)
+{
+    const float phase = sign * 2 * pi * center * x / size;
+    const float den = size * std::sin(pi * x / size);
+    if (std::abs(den) < 1e-6f)
+        return float(length) / size;
+    return std::polar(std::sin(pi * length * x / size) / den, phase);
+}
+
+} // namespace
+
+peak_extractor::sptr peak_extractor::make(ofdmradar_params::sptr ofdm_params,
+                                          int max_peaks,
+                                          float threshold,
+                                          peak_interpolation interpolation,
+                                          double sample_rate,
+                                          double carrier_freq,
+                                          bool power_input)
+{
+    return gnuradio::make_block_sptr<peak_extractor_impl>(ofdm_params,
+                                                          max_peaks,
+                                                          threshold,
+                                                          interpolation,
+                                                          sample_rate,
+                                                          carrier_freq,
+                                                          power_input);
+}
+
+peak_extractor_impl::peak_extractor_impl(ofdmradar_params::sptr ofdm_params,
+                                         int max_peaks,
+                                         float threshold,
+                                         peak_interpolation interpolation,
+                                         double sample_rate,
+                                         double carrier_freq,
+                                         bool power_input)
+    : gr::sync_block("peak_extractor",
+                     gr::io_signature::make(
+                         1, 1, power_input ? sizeof(float) : sizeof(gr_complex)),
+                     gr::io_signature::make(0, 0, 0)),
+      d_ofdm_params(ofdm_params),
+      d_max_peaks(max_peaks),
+      d_threshold(std::pow(10.0f, threshold / 10)),
+      d_interpolation(interpolation),
+      d_power_input(power_input),
+      d_peaks_port_id(pmt::intern("peaks")),
+      d_rows(ofdm_params->roi_symbols()),
+      d_cols(ofdm_params->roi_carriers()),
+      d_wrap(doppler_wraps(*ofdm_params)),
+      d_power(ofdm_params->roi_length())
+{
+    if (max_peaks < 1)
+        throw std::runtime_error(boost::str(
+            boost::format("peak_extractor: Invalid maximum of %d peaks!") % max_peaks));
+
+    if (!(sample_rate > 0) || !(carrier_freq > 0))
+        throw std::runtime_error(
+            boost::str(boost::format("peak_extractor: Sample rate (%g) and carrier "
+                                     "frequency (%g) must be positive!") %
+                       sample_rate % carrier_freq));
+
+    if (interpolation == peak_interpolation::SINC && power_input)
+        throw std::runtime_error(
+            "peak_extractor: Sinc interpolation requires the complex periodogram!");
+
+    // A periodogram range bin is a delay of carriers() / peri_carriers() samples. The
+    // receiver starts its FFT windows half a cyclic prefix into the symbols, which
+    // delays every path by as much.
+    const double metres_per_sample = speed_of_light / (2 * sample_rate);
+    d_range_step = metres_per_sample * ofdm_params->carriers() /
+                   ofdm_params->peri_carriers();
+    d_range_origin = -metres_per_sample * (ofdm_params->cyclic_prefix_length() / 2);
+
+    // A doppler bin is 1 / peri_symbols() cycles per symbol
+    const double doppler_step =
+        sample_rate / (ofdm_params->symbol_length() * ofdm_params->peri_symbols());
+    d_velocity_step = doppler_step * speed_of_light / (2 * carrier_freq);
+
+    this->set_output_multiple(ofdm_params->roi_length());
+    message_port_register_out(d_peaks_port_id);
+}
+
+peak_extractor_impl::~peak_extractor_impl() {}
+
+float peak_extractor_impl::power(int row, int col) const
+{
+    if (d_wrap)
+        row = (row + d_rows) % d_rows;
+
+    if (row < 0 || row >= d_rows || col < 0 || col >= d_cols)
+        return 0;
+
+    return d_power[row * d_cols + col];
+}
+
+gr_complex
+peak_extractor_impl::interpolate(const peak &p, bool vertical, float offset) const
+{
+    // The range IFFT runs backward over the carriers centred around DC, the doppler FFT
+    // forward over the symbols in order
+    const float zoom = d_ofdm_params->zoom();
+    const unsigned int length =
+        vertical ? d_ofdm_params->symbols() : d_ofdm_params->carriers();
+    const unsigned int size =
+        vertical ? d_ofdm_params->peri_symbols() : d_ofdm_params->peri_carriers();
+    const float center = vertical ? (length - 1) / 2.0f : -0.5f;
+    const int sign = vertical ? -1 : 1;
+
+    gr_complex value = 0;
+    for (int j = -sinc_taps; j <= sinc_taps; j++) {
+        int row = p.row + (vertical ? j : 0);
+        const int col = p.col + (vertical ? 0 : j);
+        if (d_wrap)
+            row = (row + d_rows) % d_rows;
+        if (row < 0 || row >= d_rows || col < 0 || col >= d_cols)
+            continue;
+
+        // Zoomed bins are closer than periodogram bins, and correspondingly more
+        value += d_map[doppler_input_row(row, d_rows) * d_cols + col] *
+                 dirichlet((offset - j) / zoom, length, size, center, sign) / zoom;
+    }
+
+    return value;
+}
+
+float peak_extractor_impl::refine(const peak &p, bool vertical, float &power) const
+{
+    power = p.power;
+
+    if (d_interpolation == peak_interpolation::SINC) {
+        // The maximum lies within half a bin of the peak
+        constexpr float ratio = 0.6180340f;
+        float lo = -0.5f, hi = 0.5f;
+        float x1 = hi - ratio * (hi - lo), x2 = lo + ratio * (hi - lo);
+        float p1 = std::norm(interpolate(p, vertical, x1));
+        float p2 = std::norm(interpolate(p, vertical, x2));
+        for (int i = 0; i < sinc_search_steps; i++) {
+            if (p1 < p2) {
+                lo = x1;
+                x1 = x2;
+                p1 = p2;
+                x2 = lo + ratio * (hi - lo);
+                p2 = std::norm(interpolate(p, vertical, x2));
+            } else {
+                hi = x2;
+                x2 = x1;
+                p2 = p1;
+                x1 = hi - ratio * (hi - lo);
+                p1 = std::norm(interpolate(p, vertical, x1));
+            }
+        }
+
+        const float offset = (lo + hi) / 2;
+        power = std::norm(interpolate(p, vertical, offset));
+        return offset;
+    }
+
+    const float prev = vertical ? this->power(p.row - 1, p.col)
+                                : this->power(p.row, p.col - 1);
+    const float next = vertical ? this->power(p.row + 1, p.col)
+                                : this->power(p.row, p.col + 1);
+    if (!(prev > 0) || !(next > 0))
+        return 0;
+
+    // Parabola through the log power, which fits the main lobe of the usual windows
+    // much better than the power itself
+    const float a = std::log(prev), b = std::log(p.power), c = std::log(next);
+    const float curvature = a - 2 * b + c;
+    if (!(curvature < 0))
+        return 0;
+
+    const float offset = std::max(-0.5f, std::min(0.5f, 0.5f * (a - c) / curvature));
+    power = std::exp(b - 0.25f * (a - c) * offset);
+    return offset;
+}
+
+void peak_extractor_impl::find_peaks()
+{
+    d_peaks.clear();
+
+    for (int row = 0; row < d_rows; row++) {
+        for (int col = 0; col < d_cols; col++) {
+            const float p = d_power[row * d_cols + col];
+            if (!(p > d_threshold))
+                continue;
+
+            // Of equally strong neighbours, the first in scan order is the peak
+            bool is_peak = true;
+            for (int i = -1; i <= 1 && is_peak; i++) {
+                for (int j = -1; j <= 1 && is_peak; j++) {
+                    const float q = power(row + i, col + j);
+                    if (q > p || (q == p && (i < 0 || (i == 0 && j < 0))))
+                        is_peak = false;
+                }
+            }
+
+            if (is_peak)
+                d_peaks.push_back({ row, col, p });
+        }
+    }
+
+    const auto stronger = [](const peak &a, const peak &b) { return a.power > b.power; };
+    if (int(d_peaks.size()) > d_max_peaks) {
+        std::partial_sort(
+            d_peaks.begin(), d_peaks.begin() + d_max_peaks, d_peaks.end(), stronger);
+        d_peaks.resize(d_max_peaks);
+    } else {
+        std::sort(d_peaks.begin(), d_peaks.end(), stronger);
+    }
+}
+
+int peak_extractor_impl::work(int noutput_items,
+                              gr_vector_const_void_star &input_items,
+                              gr_vector_void_star &output_items)
+{
+    const auto roi_length = d_ofdm_params->roi_length();
+    const float zoom = d_ofdm_params->zoom();
+    const size_t item_size = d_power_input ? sizeof(float) : sizeof(gr_complex);
+    const char *in = static_cast<const char *>(input_items[0]);
+
+    for (int i = 0; i + int(roi_length) <= noutput_items; i += roi_length) {
+        const void *map = &in[i * item_size];
+        if (!d_power_input)
+            d_map = static_cast<const gr_complex *>(map);
+        load_doppler_rows(map, d_power_input, d_rows, d_cols, d_power.data());
+
+        find_peaks();
+
+        d_range.clear();
+        d_velocity.clear();
+        d_range_bin.clear();
+        d_doppler_bin.clear();
+        d_peak_power.clear();
+        for (const auto &p : d_peaks) {
+            float range_power, doppler_power;
+            const float range_offset = refine(p, false, range_power);
+            const float doppler_offset = refine(p, true, doppler_power);
+
+            const float range_bin =
+                d_ofdm_params->zoom_range() + (p.col + range_offset) / zoom;
+            const float doppler_bin = d_ofdm_params->zoom_doppler() +
+                                      (p.row - d_rows / 2 + doppler_offset) / zoom;
+
+            d_range.push_back(d_range_origin + range_bin * d_range_step);
+            d_velocity.push_back(doppler_bin * d_velocity_step);
+            d_range_bin.push_back(range_bin);
+            d_doppler_bin.push_back(doppler_bin);
+
+            // Both refinements scale the power of the peak cell
+            d_peak_power.push_back(range_power * doppler_power / p.power);
+        }
+
+        pmt::pmt_t msg = pmt::make_dict();
+        msg = pmt::dict_add(msg, pmt::intern("frame"), pmt::from_uint64(d_frame++));
+        msg = pmt::dict_add(msg,
+                            pmt::intern("range"),
+                            pmt::init_f32vector(d_range.size(), d_range));
+        msg = pmt::dict_add(msg,
+                            pmt::intern("velocity"),
+                            pmt::init_f32vector(d_velocity.size(), d_velocity));
+        msg = pmt::dict_add(msg,
+                            pmt::intern("range_bin"),
+                            pmt::init_f32vector(d_range_bin.size(), d_range_bin));
+        msg = pmt::dict_add(msg,
+                            pmt::intern("doppler_bin"),
+                            pmt::init_f32vector(d_doppler_bin.size(), d_doppler_bin));
+        msg = pmt::dict_add(msg,
+                            pmt::intern("power"),
+                            pmt::init_f32vector(d_peak_power.size(), d_peak_power));
+        message_port_pub(d_peaks_port_id, msg);
+    }
+
+    return noutput_items - noutput_items % roi_length;
+}
+
+} /* namespace ofdmradar */
+} /* namespace gr */
@@ -0,0 +1,90 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2021 Analog Devices, Inc.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef INCLUDED_OFDMRADAR_PEAK_EXTRACTOR_IMPL_H
+#define INCLUDED_OFDMRADAR_PEAK_EXTRACTOR_IMPL_H
+
+#include <ofdmradar/peak_extractor.h>
+
+#include <pmt/pmt.h>
+#include <volk/volk_alloc.hh>
+
+#include <vector>
+
+namespace gr {
+namespace ofdmradar {
+
+class peak_extractor_impl : public peak_extractor
+{
+private:
+    struct peak {
+        int row; // Row of the map sorted by doppler
+        int col;
+        float power;
+    };
+
+    ofdmradar_params::sptr d_ofdm_params;
+    int d_max_peaks;
+    float d_threshold; // Linear power
+    peak_interpolation d_interpolation;
+    bool d_power_input;
+    pmt::pmt_t d_peaks_port_id;
+    uint64_t d_frame = 0;
+
+    // Metres per periodogram range bin and range of bin 0, m/s per doppler bin
+    double d_range_step;
+    double d_range_origin;
+    double d_velocity_step;
+
+    // Map dimensions, rows are sorted by doppler from negative to positive. Doppler
+    // wraps around if the map holds all peri_symbols() doppler bins.
+    int d_rows;
+    int d_cols;
+    bool d_wrap;
+    volk::vector<float> d_power;
+    const gr_complex *d_map = nullptr; // Current input, rows in FFT order
+
+    std::vector<peak> d_peaks;
+    std::vector<float> d_range, d_velocity, d_range_bin, d_doppler_bin, d_peak_power;
+
+    /*!
+     * Power of the cell, 0 outside the map
+     */
+    float power(int row, int col) const;
+
+    /*!
+     * Offset of the maximum from the cell in bins along one axis, between -0.5 and 0.5,
+     * and the interpolated power there. The axis is the doppler if vertical is set.
+     */
+    float refine(const peak &p, bool vertical, float &power) const;
+
+    /*!
+     * Sinc interpolated complex value at the given offset along one axis
+     */
+    gr_complex interpolate(const peak &p, bool vertical, float offset) const;
+
+    void find_peaks();
+
+public:
+    peak_extractor_impl(ofdmradar_params::sptr ofdm_params,
+                        int max_peaks,
+                        float threshold,
+                        peak_interpolation interpolation,
+                        double sample_rate,
+                        double carrier_freq,
+                        bool power_input);
+    ~peak_extractor_impl();
+
+    int work(int noutput_items,
+             gr_vector_const_void_star &input_items,
+             gr_vector_void_star &output_items);
+};
+
+} // namespace ofdmradar
+} // namespace gr
+
+#endif /* INCLUDED_OFDMRADAR_PEAK_EXTRACTOR_IMPL_H */
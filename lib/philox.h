@@ -0,0 +1,64 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2021 Analog Devices, Inc.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef INCLUDED_OFDMRADAR_PHILOX_H
+#define INCLUDED_OFDMRADAR_PHILOX_H
+
+#include <array>
+#include <cstdint>
+
+namespace gr {
+namespace ofdmradar {
+
+/*!
+ * \brief Counter-based random number generator Philox4x32-10
+ *
+ * Maps every 128 bit counter to four random 32 bit words under a 64 bit key. Unlike
+ * a sequential engine, any part of a random sequence can be generated directly, so
+ * e.g. the symbols of a frame can be generated independently of each other and in
+ * parallel.
+ *
+ * Based on
+ * J. K. Salmon, M. A. Moraes, R. O. Dror and D. E. Shaw,
+ * "Parallel random numbers: As easy as 1, 2, 3,"
+ * in Proceedings of the International Conference for High Performance Computing,
+ * Networking, Storage and Analysis (SC '11), 2011.
+ */
+class philox4x32
+{
+public:
+    typedef std::array<uint32_t, 4> counter_type;
+    typedef std::array<uint32_t, 2> key_type;
+
+    static counter_type generate(counter_type ctr, key_type key)
+    {
+        for (int i = 0; i < 10; i++) {
+            const uint64_t p0 = uint64_t(0xD2511F53) * ctr[0];
+            const uint64_t p1 = uint64_t(0xCD9E8D57) * ctr[2];
+            ctr = { uint32_t(p1 >> 32) ^ ctr[1] ^ key[0],
+                    uint32_t(p1),
+                    uint32_t(p0 >> 32) ^ ctr[3] ^ key[1],
+                    uint32_t(p0) };
+            key[0] += 0x9E3779B9;
+            key[1] += 0xBB67AE85;
+        }
+        return ctr;
+    }
+
+    /*!
+     * Maps a random word uniformly to 0..n-1, up to a bias of n / 2^32
+     */
+    static uint32_t below(uint32_t word, uint32_t n)
+    {
+        return uint32_t((uint64_t(word) * n) >> 32);
+    }
+};
+
+} // namespace ofdmradar
+} // namespace gr
+
+#endif /* INCLUDED_OFDMRADAR_PHILOX_H */
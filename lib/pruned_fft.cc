@@ -0,0 +1,52 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2021 Analog Devices, Inc.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "pruned_fft.h"
+
+#include <volk/volk.h>
+
+#include <cmath>
+#include <complex>
+
+namespace gr {
+namespace ofdmradar {
+
+pruned_fft::pruned_fft(int size,
+                       int factor,
+                       int howmany,
+                       int sign,
+                       gr_complex *scratch,
+                       const ofdmradar_params &params)
+    : d_size(size),
+      d_factor(factor),
+      d_howmany(howmany),
+      d_twiddles(size * factor),
+      d_fft(size, howmany, 1, size, sign, scratch, scratch, params)
+{
+    const int length = size * factor;
+
+    for (int r = 0; r < factor; r++) {
+        for (int i = 0; i < size; i++) {
+            const double phase = sign * 2 * M_PI * ((long(i) * r) % length) / length;
+            d_twiddles[r * size + i] = gr_complex(std::polar(1.0, phase));
+        }
+    }
+}
+
+void pruned_fft::execute(const gr_complex *in, gr_complex *scratch, int residue) const
+{
+    const gr_complex *twiddles = &d_twiddles[residue * d_size];
+
+    for (int i = 0; i < d_howmany; i++)
+        volk_32fc_x2_multiply_32fc(
+            &scratch[i * d_size], &in[i * d_size], twiddles, d_size);
+
+    d_fft.execute(scratch, scratch);
+}
+
+} /* namespace ofdmradar */
+} /* namespace gr */
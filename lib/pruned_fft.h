@@ -0,0 +1,70 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2021 Analog Devices, Inc.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef INCLUDED_OFDMRADAR_PRUNED_FFT_H
+#define INCLUDED_OFDMRADAR_PRUNED_FFT_H
+
+#include "batched_fft.h"
+
+#include <volk/volk_alloc.hh>
+
+namespace gr {
+namespace ofdmradar {
+
+/*!
+ * \brief A batch of zero-padded transforms of length size * factor, computed from
+ *        their size non-zero inputs only.
+ *
+ * The inputs are followed by their zero padding. Output element k = q * factor + r
+ * of a padded transform is then
+ *
+ *   X[q * factor + r] = sum_i (x[i] * w^(i * r)) * v^(i * q)
+ *
+ * with w the twiddle of the padded length and v the one of size. Every residue r
+ * therefore takes one twiddle multiply and one size point transform, instead of
+ * running the full length transform over mostly zeros.
+ */
+class pruned_fft
+{
+private:
+    int d_size;
+    int d_factor;
+    int d_howmany;
+    volk::vector<gr_complex> d_twiddles;
+    batched_fft d_fft;
+
+public:
+    /*!
+     * \param size     Number of non-zero inputs of every transform
+     * \param factor   Padding factor, the padded transform length is size * factor
+     * \param howmany  Number of transforms in the batch, inputs are packed with a
+     *                 distance of size
+     * \param sign     FFTW_FORWARD or FFTW_BACKWARD
+     * \param scratch  Scratch buffer of howmany * size elements used for planning
+     * \param params   Supplies the planning effort and the wisdom file
+     */
+    pruned_fft(int size,
+               int factor,
+               int howmany,
+               int sign,
+               gr_complex *scratch,
+               const ofdmradar_params &params);
+
+    int factor() const { return d_factor; }
+
+    /*!
+     * Computes output elements q * factor + residue, q = 0..size-1, of every
+     * transform in the batch. Element q of transform i is stored at
+     * scratch[i * size + q].
+     */
+    void execute(const gr_complex *in, gr_complex *scratch, int residue) const;
+};
+
+} // namespace ofdmradar
+} // namespace gr
+
+#endif /* INCLUDED_OFDMRADAR_PRUNED_FFT_H */
@@ -0,0 +1,64 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2021 Analog Devices Inc.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "ofdmradar_impl.h"
+
+#include <gnuradio/attributes.h>
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+namespace gr {
+namespace ofdmradar {
+
+namespace {
+
+class tx_generator : public ofdmradar_shared
+{
+public:
+    using ofdmradar_shared::generate_tx_indices;
+    using ofdmradar_shared::generate_tx_symbols;
+    using ofdmradar_shared::ofdmradar_shared;
+};
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(test_tx_indices_match_symbols)
+{
+    // 254 carriers end on a partial block of four words
+    const unsigned int n = 254, m = 4;
+    const std::vector<std::vector<gr_complex>> constellations = {
+        get_constellation(modulation_scheme::QPSK),
+        get_constellation(modulation_scheme::PSK, 8),
+        get_constellation(modulation_scheme::QAM, 256),
+    };
+
+    for (const auto &constellation : constellations) {
+        auto params = ofdmradar_params::make(
+            n, m, n, m, n / 8, 1, n / 16, 5, constellation, 1234, fft_effort::ESTIMATE);
+        const tx_generator generator(params);
+        const auto &mask = params->carrier_mask();
+
+        std::vector<uint8_t> indices(n);
+        std::vector<gr_complex> symbols(n);
+        for (uint64_t frame : { 0ULL, 1ULL, 1ULL << 33 }) {
+            for (unsigned int symbol = 0; symbol < m; symbol++) {
+                generator.generate_tx_indices(indices.data(), symbol, frame);
+                generator.generate_tx_symbols(symbols.data(), symbol, frame);
+
+                for (unsigned int i = 0; i < n; i++) {
+                    BOOST_REQUIRE_LT(indices[i], constellation.size());
+                    const gr_complex expected = mask[i] ? constellation[indices[i]] : 0;
+                    BOOST_CHECK_EQUAL(symbols[i], expected);
+                }
+            }
+        }
+    }
+}
+
+} /* namespace ofdmradar */
+} /* namespace gr */
@@ -0,0 +1,53 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2021 Analog Devices Inc.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "philox.h"
+
+#include <gnuradio/attributes.h>
+#include <boost/test/unit_test.hpp>
+
+namespace gr {
+namespace ofdmradar {
+
+BOOST_AUTO_TEST_CASE(test_philox_known_answers)
+{
+    // Known answer vectors for philox4x32_10 from the Random123 distribution
+    struct kat {
+        philox4x32::counter_type ctr;
+        philox4x32::key_type key;
+        philox4x32::counter_type expected;
+    };
+    const kat kats[] = {
+        { { 0x00000000, 0x00000000, 0x00000000, 0x00000000 },
+          { 0x00000000, 0x00000000 },
+          { 0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8 } },
+        { { 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff },
+          { 0xffffffff, 0xffffffff },
+          { 0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd } },
+        { { 0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344 },
+          { 0xa4093822, 0x299f31d0 },
+          { 0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1 } },
+    };
+
+    for (const auto &k : kats) {
+        const auto words = philox4x32::generate(k.ctr, k.key);
+        BOOST_CHECK_EQUAL_COLLECTIONS(
+            words.begin(), words.end(), k.expected.begin(), k.expected.end());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_philox_below)
+{
+    BOOST_CHECK_EQUAL(philox4x32::below(0x00000000, 4), 0U);
+    BOOST_CHECK_EQUAL(philox4x32::below(0x3fffffff, 4), 0U);
+    BOOST_CHECK_EQUAL(philox4x32::below(0x40000000, 4), 1U);
+    BOOST_CHECK_EQUAL(philox4x32::below(0xffffffff, 4), 3U);
+    BOOST_CHECK_EQUAL(philox4x32::below(0xffffffff, 256), 255U);
+}
+
+} /* namespace ofdmradar */
+} /* namespace gr */
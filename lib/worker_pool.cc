@@ -0,0 +1,90 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2021 Analog Devices, Inc.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "worker_pool.h"
+
+#include <algorithm>
+
+namespace gr {
+namespace ofdmradar {
+
+worker_pool::worker_pool(unsigned int nthreads) : d_next_job(0)
+{
+    for (unsigned int i = 1; i < nthreads; i++)
+        d_threads.emplace_back([this, i]() { thread_main(i); });
+}
+
+unsigned int worker_pool::thread_count(int nthreads)
+{
+    return nthreads > 0 ? nthreads : std::max(1U, std::thread::hardware_concurrency());
+}
+
+worker_pool::~worker_pool()
+{
+    {
+        std::lock_guard<std::mutex> lock(d_mutex);
+        d_stop = true;
+    }
+    d_start_cond.notify_all();
+
+    for (auto &t : d_threads)
+        t.join();
+}
+
+void worker_pool::run_jobs(unsigned int worker)
+{
+    for (unsigned int job = d_next_job++; job < d_njobs; job = d_next_job++)
+        (*d_job)(job, worker);
+}
+
+void worker_pool::thread_main(unsigned int worker)
+{
+    uint64_t generation = 0;
+
+    std::unique_lock<std::mutex> lock(d_mutex);
+    for (;;) {
+        d_start_cond.wait(lock, [&]() { return d_stop || d_generation != generation; });
+        if (d_stop)
+            return;
+
+        generation = d_generation;
+        lock.unlock();
+
+        run_jobs(worker);
+
+        lock.lock();
+        if (--d_busy == 0)
+            d_done_cond.notify_one();
+    }
+}
+
+void worker_pool::run(unsigned int njobs, const job_fn &job)
+{
+    if (d_threads.empty() || njobs < 2) {
+        for (unsigned int i = 0; i < njobs; i++)
+            job(i, 0);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(d_mutex);
+        d_job = &job;
+        d_njobs = njobs;
+        d_next_job = 0;
+        d_busy = d_threads.size();
+        d_generation++;
+    }
+    d_start_cond.notify_all();
+
+    run_jobs(0);
+
+    std::unique_lock<std::mutex> lock(d_mutex);
+    d_done_cond.wait(lock, [this]() { return d_busy == 0; });
+}
+
+} /* namespace ofdmradar */
+} /* namespace gr */
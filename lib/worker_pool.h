@@ -0,0 +1,79 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2021 Analog Devices, Inc.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef INCLUDED_OFDMRADAR_WORKER_POOL_H
+#define INCLUDED_OFDMRADAR_WORKER_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace gr {
+namespace ofdmradar {
+
+/*!
+ * \brief Fixed set of threads that work through a list of independent jobs.
+ *
+ * The calling thread takes part in the work, so a pool of size one runs everything
+ * inline without any synchronisation.
+ */
+class worker_pool
+{
+public:
+    /*!
+     * Called with the job index and the index of the worker executing it. Worker
+     * indices are < size() and can be used to select per-thread scratch memory.
+     */
+    typedef std::function<void(unsigned int job, unsigned int worker)> job_fn;
+
+private:
+    std::vector<std::thread> d_threads;
+    std::mutex d_mutex;
+    std::condition_variable d_start_cond;
+    std::condition_variable d_done_cond;
+    const job_fn *d_job = nullptr;
+    unsigned int d_njobs = 0;
+    std::atomic<unsigned int> d_next_job;
+    unsigned int d_busy = 0;
+    uint64_t d_generation = 0;
+    bool d_stop = false;
+
+    void thread_main(unsigned int worker);
+    void run_jobs(unsigned int worker);
+
+public:
+    /*!
+     * \param nthreads Total number of threads including the caller of run()
+     */
+    explicit worker_pool(unsigned int nthreads);
+    ~worker_pool();
+
+    worker_pool(const worker_pool &) = delete;
+    worker_pool &operator=(const worker_pool &) = delete;
+
+    unsigned int size() const { return d_threads.size() + 1; }
+
+    /*!
+     * Number of threads for a block's nthreads parameter, all hardware threads if
+     * it is not positive
+     */
+    static unsigned int thread_count(int nthreads);
+
+    /*!
+     * Runs jobs 0..njobs-1 and returns once all of them are done
+     */
+    void run(unsigned int njobs, const job_fn &job);
+};
+
+} // namespace ofdmradar
+} // namespace gr
+
+#endif /* INCLUDED_OFDMRADAR_WORKER_POOL_H */
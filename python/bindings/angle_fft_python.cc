@@ -0,0 +1,47 @@
+/*
+ * Copyright 2021 Free Software Foundation, Inc.
+ *
+ * This file is part of GNU Radio
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+/***********************************************************************************/
+/* This file is automatically generated using bindtool and can be manually edited  */
+/* The following lines can be configured to regenerate this file during cmake      */
+/* If manual edits are made, the following tags should be modified accordingly.    */
+/* BINDTOOL_GEN_AUTOMATIC(0)                                                       */
+/* BINDTOOL_USE_PYGCCXML(0)                                                        */
+/* BINDTOOL_HEADER_FILE(angle_fft.h)                                        */
+/* BINDTOOL_HEADER_FILE_HASH(5fbda2859ff2946d1ea9a8cc50b78531)                     */
+/***********************************************************************************/
+
+#include <pybind11/complex.h>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+namespace py = pybind11;
+
+#include <ofdmradar/angle_fft.h>
+// pydoc.h is automatically generated in the build directory
+#include <angle_fft_pydoc.h>
+
+void bind_angle_fft(py::module &m)
+{
+    using angle_fft = gr::ofdmradar::angle_fft;
+
+    py::class_<angle_fft,
+               gr::sync_block,
+               gr::block,
+               gr::basic_block,
+               std::shared_ptr<angle_fft>>(m, "angle_fft", D(angle_fft))
+
+        .def(py::init(&angle_fft::make),
+             py::arg("ofdm_params"),
+             py::arg("array_size"),
+             py::arg("angle_bins"),
+             py::arg("max_projection") = false,
+             py::arg("nthreads") = 1,
+             D(angle_fft, make));
+}
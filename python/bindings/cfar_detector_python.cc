@@ -0,0 +1,58 @@
+/*
+ * Copyright 2021 Free Software Foundation, Inc.
+ *
+ * This file is part of GNU Radio
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+/***********************************************************************************/
+/* This file is automatically generated using bindtool and can be manually edited  */
+/* The following lines can be configured to regenerate this file during cmake      */
+/* If manual edits are made, the following tags should be modified accordingly.    */
+/* BINDTOOL_GEN_AUTOMATIC(0)                                                       */
+/* BINDTOOL_USE_PYGCCXML(0)                                                        */
+/* BINDTOOL_HEADER_FILE(cfar_detector.h)                                        */
+/* BINDTOOL_HEADER_FILE_HASH(eaec5ea813327bfdba7761fa8ab4cbc7)                     */
+/***********************************************************************************/
+
+#include <pybind11/complex.h>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+namespace py = pybind11;
+
+#include <ofdmradar/cfar_detector.h>
+// pydoc.h is automatically generated in the build directory
+#include <cfar_detector_pydoc.h>
+
+void bind_cfar_detector(py::module &m)
+{
+    using cfar_mode = gr::ofdmradar::cfar_mode;
+
+    py::enum_<cfar_mode>(m, "cfar_mode", D(cfar_mode))
+        .value("CA", cfar_mode::CA)
+        .value("GO", cfar_mode::GO)
+        .value("OS", cfar_mode::OS);
+
+    using cfar_detector = gr::ofdmradar::cfar_detector;
+
+    py::class_<cfar_detector,
+               gr::sync_block,
+               gr::block,
+               gr::basic_block,
+               std::shared_ptr<cfar_detector>>(m, "cfar_detector", D(cfar_detector))
+
+        .def(py::init(&cfar_detector::make),
+             py::arg("ofdm_params"),
+             py::arg("mode"),
+             py::arg("guard_range"),
+             py::arg("guard_doppler"),
+             py::arg("train_range"),
+             py::arg("train_doppler"),
+             py::arg("threshold"),
+             py::arg("rank") = 0.75f,
+             py::arg("power_input") = false,
+             D(cfar_detector, make));
+}
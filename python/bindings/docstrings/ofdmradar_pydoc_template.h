@@ -14,6 +14,10 @@
   and will be overwritten during the build process
  */
 
+static const char *__doc_gr_ofdmradar_fft_effort = R"doc()doc";
+
+static const char *__doc_gr_ofdmradar_sample_format = R"doc()doc";
+
 static const char *__doc_gr_ofdmradar_ofdmradar_params = R"doc()doc";
 
 static const char *__doc_gr_ofdmradar_ofdmradar_params_make = R"doc()doc";
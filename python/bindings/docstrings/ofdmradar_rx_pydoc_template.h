@@ -22,3 +22,6 @@ static const char *__doc_gr_ofdmradar_ofdmradar_rx_ofdmradar_rx = R"doc()doc";
 
 
 static const char *__doc_gr_ofdmradar_ofdmradar_rx_make = R"doc()doc";
+
+
+static const char *__doc_gr_ofdmradar_ofdmradar_rx_frames_dropped = R"doc()doc";
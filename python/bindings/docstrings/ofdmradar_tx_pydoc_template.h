@@ -22,3 +22,9 @@ static const char *__doc_gr_ofdmradar_ofdmradar_tx_ofdmradar_tx = R"doc()doc";
 
 
 static const char *__doc_gr_ofdmradar_ofdmradar_tx_make = R"doc()doc";
+
+
+static const char *__doc_gr_ofdmradar_ofdmradar_tx_papr = R"doc()doc";
+
+
+static const char *__doc_gr_ofdmradar_ofdmradar_tx_clipped_samples = R"doc()doc";
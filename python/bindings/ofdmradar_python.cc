@@ -14,7 +14,7 @@
 /* BINDTOOL_GEN_AUTOMATIC(0)                                                       */
 /* BINDTOOL_USE_PYGCCXML(0)                                                        */
 /* BINDTOOL_HEADER_FILE(ofdmradar.h)                                               */
-/* BINDTOOL_HEADER_FILE_HASH(28077ff7afa14566e1bc2cc9621f8386)                     */
+/* BINDTOOL_HEADER_FILE_HASH(4e652acc9c9dd83b2cc63289e8cb5b0e)                     */
 /***********************************************************************************/
 
 #include <pybind11/complex.h>
@@ -29,6 +29,18 @@ namespace py = pybind11;
 
 void bind_ofdmradar(py::module &m)
 {
+    using fft_effort = gr::ofdmradar::fft_effort;
+    py::enum_<fft_effort>(m, "fft_effort", D(fft_effort))
+        .value("ESTIMATE", fft_effort::ESTIMATE)
+        .value("MEASURE", fft_effort::MEASURE)
+        .value("PATIENT", fft_effort::PATIENT);
+
+    using sample_format = gr::ofdmradar::sample_format;
+
+    py::enum_<sample_format>(m, "sample_format", D(sample_format))
+        .value("FC32", sample_format::FC32)
+        .value("SC16", sample_format::SC16);
+
     using ofdmradar_params = gr::ofdmradar::ofdmradar_params;
 
     py::class_<ofdmradar_params, ofdmradar_params::sptr>(
@@ -44,6 +56,13 @@ void bind_ofdmradar(py::module &m)
              py::arg("window_type"),
              py::arg("constellation"),
              py::arg("seed"),
+             py::arg("planning_effort") = fft_effort::MEASURE,
+             py::arg("wisdom_file") = "",
+             py::arg("roi_carriers") = 0,
+             py::arg("roi_symbols") = 0,
+             py::arg("zoom") = 1.0f,
+             py::arg("zoom_range") = 0.0f,
+             py::arg("zoom_doppler") = 0.0f,
              D(ofdmradar_params, make))
 
         .def("__str__", &ofdmradar_params::python_str)
@@ -54,6 +73,13 @@ void bind_ofdmradar(py::module &m)
         .def_property_readonly("peri_carriers", &ofdmradar_params::peri_carriers)
         .def_property_readonly("peri_symbols", &ofdmradar_params::peri_symbols)
         .def_property_readonly("peri_length", &ofdmradar_params::peri_length)
+        .def_property_readonly("roi_carriers", &ofdmradar_params::roi_carriers)
+        .def_property_readonly("roi_symbols", &ofdmradar_params::roi_symbols)
+        .def_property_readonly("roi_length", &ofdmradar_params::roi_length)
+        .def_property_readonly("zoom", &ofdmradar_params::zoom)
+        .def_property_readonly("zoom_range", &ofdmradar_params::zoom_range)
+        .def_property_readonly("zoom_doppler", &ofdmradar_params::zoom_doppler)
+        .def_property_readonly("zoomed", &ofdmradar_params::zoomed)
         .def_property_readonly("cyclic_prefix_length",
                                &ofdmradar_params::cyclic_prefix_length)
         .def_property_readonly("dc_guard", &ofdmradar_params::dc_guard)
@@ -64,6 +90,8 @@ void bind_ofdmradar(py::module &m)
         .def_property_readonly("symbol_length", &ofdmradar_params::symbol_length)
         .def_property_readonly("frame_length", &ofdmradar_params::frame_length)
         .def_property_readonly("carrier_mask", &ofdmradar_params::carrier_mask)
+        .def_property_readonly("planning_effort", &ofdmradar_params::planning_effort)
+        .def_property_readonly("wisdom_file", &ofdmradar_params::wisdom_file)
 
         .def("window", &ofdmradar_params::window, py::arg("ntaps"));
 
@@ -14,7 +14,7 @@
 /* BINDTOOL_GEN_AUTOMATIC(0)                                                       */
 /* BINDTOOL_USE_PYGCCXML(0)                                                        */
 /* BINDTOOL_HEADER_FILE(ofdmradar_rx.h)                                        */
-/* BINDTOOL_HEADER_FILE_HASH(3414504ebbcd833ddfd0bdb784addf19)                     */
+/* BINDTOOL_HEADER_FILE_HASH(7651873e51db39aa606c43e822ebe0d3)                     */
 /***********************************************************************************/
 
 #include <pybind11/complex.h>
@@ -38,5 +38,24 @@ void bind_ofdmradar_rx(py::module &m)
     py::class_<ofdmradar_rx, gr::block, gr::basic_block, std::shared_ptr<ofdmradar_rx>>(
         m, "ofdmradar_rx", D(ofdmradar_rx))
 
-        .def(py::init(&ofdmradar_rx::make), D(ofdmradar_rx, make));
+        .def(py::init(&ofdmradar_rx::make),
+             py::arg("ofdm_params"),
+             py::arg("len_tag_key"),
+             py::arg("buffer_size"),
+             py::arg("nthreads") = 1,
+             py::arg("frame_buffers") = 1,
+             py::arg("hop") = 0,
+             py::arg("acquire") = false,
+             py::arg("format") = gr::ofdmradar::sample_format::FC32,
+             py::arg("integration") = 0,
+             py::arg("exponential") = false,
+             py::arg("clutter_alpha") = 0,
+             py::arg("notch") = false,
+             py::arg("channels") = 1,
+             py::arg("waveforms") = 1,
+             D(ofdmradar_rx, make))
+
+        .def("frames_dropped",
+             &ofdmradar_rx::frames_dropped,
+             D(ofdmradar_rx, frames_dropped));
 }
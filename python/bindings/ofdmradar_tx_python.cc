@@ -14,7 +14,7 @@
 /* BINDTOOL_GEN_AUTOMATIC(0)                                                       */
 /* BINDTOOL_USE_PYGCCXML(0)                                                        */
 /* BINDTOOL_HEADER_FILE(ofdmradar_tx.h)                                            */
-/* BINDTOOL_HEADER_FILE_HASH(53535eec94d43359bfac1cc8c5533879)                     */
+/* BINDTOOL_HEADER_FILE_HASH(8af8dfdd4f17987f836e572421ecf603)                     */
 /***********************************************************************************/
 
 #include <pybind11/complex.h>
@@ -41,7 +41,16 @@ void bind_ofdmradar_tx(py::module &m)
         .def(py::init(&ofdmradar_tx::make),
              py::arg("ofdm_params"),
              py::arg("len_tag_key") = "packet_len",
+             py::arg("waveforms") = 1,
+             py::arg("gap") = 0,
+             py::arg("burst_tags") = false,
+             py::arg("format") = gr::ofdmradar::sample_format::FC32,
+             py::arg("backoff") = 0,
              D(ofdmradar_tx, make))
 
-        ;
+        .def("papr", &ofdmradar_tx::papr, D(ofdmradar_tx, papr))
+
+        .def("clipped_samples",
+             &ofdmradar_tx::clipped_samples,
+             D(ofdmradar_tx, clipped_samples));
 }
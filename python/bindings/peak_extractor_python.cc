@@ -0,0 +1,55 @@
+/*
+ * Copyright 2021 Free Software Foundation, Inc.
+ *
+ * This file is part of GNU Radio
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+/***********************************************************************************/
+/* This file is automatically generated using bindtool and can be manually edited  */
+/* The following lines can be configured to regenerate this file during cmake      */
+/* If manual edits are made, the following tags should be modified accordingly.    */
+/* BINDTOOL_GEN_AUTOMATIC(0)                                                       */
+/* BINDTOOL_USE_PYGCCXML(0)                                                        */
+/* BINDTOOL_HEADER_FILE(peak_extractor.h)                                        */
+/* BINDTOOL_HEADER_FILE_HASH(967f42f091338b3f247d98a36e69cac7)                     */
+/***********************************************************************************/
+
+#include <pybind11/complex.h>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+namespace py = pybind11;
+
+#include <ofdmradar/peak_extractor.h>
+// pydoc.h is automatically generated in the build directory
+#include <peak_extractor_pydoc.h>
+
+void bind_peak_extractor(py::module &m)
+{
+    using peak_interpolation = gr::ofdmradar::peak_interpolation;
+
+    py::enum_<peak_interpolation>(m, "peak_interpolation", D(peak_interpolation))
+        .value("PARABOLIC", peak_interpolation::PARABOLIC)
+        .value("SINC", peak_interpolation::SINC);
+
+    using peak_extractor = gr::ofdmradar::peak_extractor;
+
+    py::class_<peak_extractor,
+               gr::sync_block,
+               gr::block,
+               gr::basic_block,
+               std::shared_ptr<peak_extractor>>(m, "peak_extractor", D(peak_extractor))
+
+        .def(py::init(&peak_extractor::make),
+             py::arg("ofdm_params"),
+             py::arg("max_peaks"),
+             py::arg("threshold"),
+             py::arg("interpolation"),
+             py::arg("sample_rate"),
+             py::arg("carrier_freq"),
+             py::arg("power_input") = false,
+             D(peak_extractor, make));
+}
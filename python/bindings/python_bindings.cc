@@ -29,6 +29,9 @@ namespace py = pybind11;
     void bind_array_music(py::module& m);
     void bind_array_esprit(py::module& m);
     void bind_array_calib(py::module& m);
+    void bind_cfar_detector(py::module& m);
+    void bind_peak_extractor(py::module& m);
+    void bind_angle_fft(py::module& m);
 // ) END BINDING_FUNCTION_PROTOTYPES
 
 
@@ -65,5 +68,8 @@ PYBIND11_MODULE(ofdmradar_python, m)
     bind_array_music(m);
     bind_array_esprit(m);
     bind_array_calib(m);
+    bind_cfar_detector(m);
+    bind_peak_extractor(m);
+    bind_angle_fft(m);
     // ) END BINDING_FUNCTION_CALLS
 }
\ No newline at end of file
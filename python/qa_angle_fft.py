@@ -0,0 +1,102 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+#
+# Copyright 2021 Analog Devices Inc.
+#
+# SPDX-License-Identifier: GPL-3.0-or-later
+#
+
+from gnuradio import gr, gr_unittest, blocks
+import numpy as np
+import pmt
+try:
+    from ofdmradar import ofdmradar_params, get_constellation, modulation_scheme, \
+        fft_effort, angle_fft
+except ImportError:
+    import os
+    import sys
+    dirname, filename = os.path.split(os.path.abspath(__file__))
+    d = os.path.join(dirname, "bindings")
+    sys.path.append(d)
+    from ofdmradar import ofdmradar_params, get_constellation, modulation_scheme, \
+        fft_effort, angle_fft
+
+ELEMENTS = 8
+ANGLE_BINS = 64
+
+
+def plane_wave(sin_angle, cells=1):
+    """ Cells of a half wavelength spaced array receiving from sin_angle, with the
+    steering vectors of array_music """
+    k = np.arange(ELEMENTS)
+    return np.tile(np.exp(1j * np.pi * k * sin_angle), cells).astype(np.complex64)
+
+
+def bin_sin(b):
+    return 2.0 * (b - ANGLE_BINS // 2) / ANGLE_BINS
+
+
+class qa_angle_fft(gr_unittest.TestCase):
+
+    def setUp(self):
+        self.tb = gr.top_block()
+        self.params = ofdmradar_params(64, 16, 64, 16, 8, 1, 2, 0,
+                                       get_constellation(modulation_scheme.QPSK), 0,
+                                       fft_effort.ESTIMATE)
+
+    def tearDown(self):
+        self.tb = None
+
+    def run_cube(self, cells, calib=None, nthreads=1):
+        src = blocks.vector_source_c(cells.tolist(), False, ELEMENTS)
+        afft = angle_fft(self.params, ELEMENTS, ANGLE_BINS, False, nthreads)
+        dst = blocks.vector_sink_f(ANGLE_BINS)
+        self.tb.connect(src, afft, dst)
+        if calib is not None:
+            # Blobs are u8 vectors
+            data = np.asarray(calib, dtype=np.complex64).tobytes()
+            afft.to_basic_block()._post(pmt.intern("calib"),
+                                        pmt.init_u8vector(len(data), list(data)))
+        self.tb.run()
+        return np.array(dst.data()).reshape(-1, ANGLE_BINS)
+
+    def test_001_steering(self):
+        # Every on-bin angle, including the most negative one, peaks in its bin with
+        # the power of the coherent sum divided by the number of elements
+        bins = range(0, ANGLE_BINS, 5)
+        cells = np.concatenate([plane_wave(bin_sin(b)) for b in bins])
+        spectra = self.run_cube(cells, nthreads=2)
+        for b, spectrum in zip(bins, spectra):
+            self.assertEqual(np.argmax(spectrum), b)
+            self.assertAlmostEqual(spectrum[b], ELEMENTS, places=3)
+
+    def test_002_max_projection(self):
+        sin_angle = bin_sin(42)
+        src = blocks.vector_source_c(plane_wave(sin_angle, 3).tolist(), False, ELEMENTS)
+        afft = angle_fft(self.params, ELEMENTS, ANGLE_BINS, True)
+        power = blocks.vector_sink_f()
+        angle = blocks.vector_sink_f()
+        self.tb.connect(src, afft, power)
+        self.tb.connect((afft, 1), angle)
+        self.tb.run()
+        self.assertFloatTuplesAlmostEqual(power.data(), [ELEMENTS] * 3, 3)
+        self.assertFloatTuplesAlmostEqual(angle.data(), [np.arcsin(sin_angle)] * 3, 5)
+
+    def test_003_calibration(self):
+        # Per element phase errors smear the beam, the calibration gains restore it
+        sin_angle = bin_sin(20)
+        errors = np.exp(1j * np.random.RandomState(3).uniform(-np.pi, np.pi, ELEMENTS))
+        cells = (plane_wave(sin_angle) * errors).astype(np.complex64)
+
+        uncalibrated = self.run_cube(cells)[0]
+        self.assertLess(uncalibrated[20], 0.9 * ELEMENTS)
+
+        # Only the phase of the gains is applied
+        self.tb = gr.top_block()
+        calibrated = self.run_cube(cells, calib=2.5 * errors)[0]
+        self.assertEqual(np.argmax(calibrated), 20)
+        self.assertAlmostEqual(calibrated[20], ELEMENTS, places=3)
+
+
+if __name__ == '__main__':
+    gr_unittest.run(qa_angle_fft)
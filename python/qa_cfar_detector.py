@@ -0,0 +1,159 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+#
+# Copyright 2021 Analog Devices Inc.
+#
+# SPDX-License-Identifier: GPL-3.0-or-later
+#
+
+from gnuradio import gr, gr_unittest, blocks
+import numpy as np
+import pmt
+try:
+    from ofdmradar import ofdmradar_params, get_constellation, modulation_scheme, \
+        fft_effort, cfar_detector, cfar_mode
+except ImportError:
+    import os
+    import sys
+    dirname, filename = os.path.split(os.path.abspath(__file__))
+    d = os.path.join(dirname, "bindings")
+    sys.path.append(d)
+    from ofdmradar import ofdmradar_params, get_constellation, modulation_scheme, \
+        fft_effort, cfar_detector, cfar_mode
+
+GUARD = 1
+TRAIN = 3
+THRESHOLD = 13
+RANK = 0.75
+
+
+def make_params(peri_carriers=64, peri_symbols=32):
+    return ofdmradar_params(32, 16, peri_carriers, peri_symbols, 8, 1, 2, 0,
+                            get_constellation(modulation_scheme.QPSK), 0,
+                            fft_effort.ESTIMATE)
+
+
+def expected_snr(power, row, col, mode, wrap, train_range=TRAIN):
+    """ SNR in dB of a cell of a map sorted by doppler, from the same training cells
+    the detector uses """
+    rows, cols = power.shape
+    cells = []
+    for r in range(row - GUARD - TRAIN, row + GUARD + TRAIN + 1):
+        if not wrap and not 0 <= r < rows:
+            continue
+        for c in range(max(0, col - GUARD - train_range),
+                       min(cols, col + GUARD + train_range + 1)):
+            if abs(r - row) > GUARD or abs(c - col) > GUARD:
+                cells.append((power[r % rows, c], c))
+    values = np.array([v for v, c in cells], dtype=np.float64)
+
+    if mode == cfar_mode.CA:
+        level = values.mean()
+    elif mode == cfar_mode.GO:
+        level = max(np.mean([v for v, c in cells if c <= col]),
+                    np.mean([v for v, c in cells if c >= col]))
+    else:
+        level = np.sort(values)[int(RANK * (len(values) - 1) + 0.5)]
+    return 10 * np.log10(power[row, col] / level)
+
+
+class qa_cfar_detector(gr_unittest.TestCase):
+
+    def setUp(self):
+        self.tb = gr.top_block()
+        self.rng = np.random.RandomState(7)
+
+    def tearDown(self):
+        self.tb = None
+
+    def noise(self, params):
+        shape = (params.roi_symbols, params.roi_carriers)
+        return ((self.rng.randn(*shape) + 1j * self.rng.randn(*shape)) /
+                np.sqrt(2)).astype(np.complex64)
+
+    def detect(self, params, fft_map, mode, train_range=TRAIN):
+        """ Runs one map with rows in FFT order through the detector and returns its
+        detections as (range, doppler) -> snr """
+        src = blocks.vector_source_c(fft_map.flatten().tolist(), False)
+        cfar = cfar_detector(params, mode, GUARD, GUARD, train_range, TRAIN, THRESHOLD,
+                             RANK)
+        dbg = blocks.message_debug()
+        self.tb.connect(src, cfar)
+        self.tb.msg_connect((cfar, "detections"), (dbg, "store"))
+        self.tb.run()
+
+        self.assertEqual(dbg.num_messages(), 1)
+        msg = dbg.get_message(0)
+        fields = [pmt.f32vector_elements(pmt.dict_ref(msg, pmt.intern(key), pmt.PMT_NIL))
+                  for key in ("range", "doppler", "snr")]
+        return {(r, d): s for r, d, s in zip(*fields)}
+
+    def check_targets(self, params, targets, modes, train_range=TRAIN):
+        """ targets are (range, doppler) bins, doppler from -roi_symbols / 2 """
+        rows = params.roi_symbols
+        wrap = rows == params.peri_symbols and not params.zoomed
+        sorted_map = self.noise(params)
+        for r, d in targets:
+            sorted_map[d + rows // 2, r] = 30
+        power = np.abs(sorted_map.astype(np.complex128)) ** 2
+        fft_map = np.fft.ifftshift(sorted_map, axes=0)
+
+        for mode in modes:
+            self.tb = gr.top_block()
+            detections = self.detect(params, fft_map, mode, train_range)
+            self.assertEqual(sorted(detections), sorted(targets))
+            for r, d in targets:
+                snr = expected_snr(power, d + rows // 2, r, mode, wrap, train_range)
+                self.assertAlmostEqual(detections[(r, d)], snr, places=3)
+
+    def test_001_modes(self):
+        self.check_targets(make_params(), [(20, 5), (40, -9)],
+                           [cfar_mode.CA, cfar_mode.GO, cfar_mode.OS])
+
+    def test_002_doppler_wrap(self):
+        # The first and last doppler rows train on the rows at the other edge
+        params = make_params()
+        self.check_targets(params, [(10, -16), (30, 15)],
+                           [cfar_mode.CA, cfar_mode.GO, cfar_mode.OS])
+
+    def test_003_doppler_wrap_interference(self):
+        # A strong row at the top edge masks a target at the bottom edge only if the
+        # window wraps around
+        params = make_params()
+        sorted_map = self.noise(params)
+        sorted_map[-1, :] *= 10
+        sorted_map[0, 30] = 12
+        detections = self.detect(params, np.fft.ifftshift(sorted_map, axes=0),
+                                 cfar_mode.CA)
+        self.assertNotIn((30, -16), detections)
+
+    def test_004_range_edge(self):
+        # The window is cut off at the first and last range bins, so the level comes
+        # from fewer training cells, but the SNR stays that of the target
+        params = make_params()
+        self.check_targets(params, [(0, 3), (63, -4)],
+                           [cfar_mode.CA, cfar_mode.GO, cfar_mode.OS])
+
+        sorted_map = self.noise(params)
+        sorted_map[3 + 16, 0] = 30
+        self.tb = gr.top_block()
+        detections = self.detect(params, np.fft.ifftshift(sorted_map, axes=0),
+                                 cfar_mode.CA)
+        self.assertAlmostEqual(detections[(0, 3)], 10 * np.log10(900), delta=3)
+
+    def test_005_no_wrap_with_roi(self):
+        # A region of interest does not hold all doppler bins and does not wrap
+        params = ofdmradar_params(32, 16, 64, 32, 8, 1, 2, 0,
+                                  get_constellation(modulation_scheme.QPSK), 0,
+                                  fft_effort.ESTIMATE, "", 64, 24)
+        self.check_targets(params, [(10, -12), (30, 11)], [cfar_mode.CA])
+
+    def test_006_doppler_training_only(self):
+        # Without training cells in range, GO falls back to those of the cell's own
+        # range bin in both halves
+        self.check_targets(make_params(), [(20, 5), (40, -9)],
+                           [cfar_mode.CA, cfar_mode.GO, cfar_mode.OS], train_range=0)
+
+
+if __name__ == '__main__':
+    gr_unittest.run(qa_cfar_detector)
@@ -0,0 +1,119 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+#
+# Copyright 2021 Analog Devices Inc.
+#
+# SPDX-License-Identifier: GPL-3.0-or-later
+#
+
+from gnuradio import gr, gr_unittest, blocks
+import numpy as np
+import pmt
+try:
+    from ofdmradar import ofdmradar_params, get_constellation, modulation_scheme, \
+        fft_effort, peak_extractor, peak_interpolation
+except ImportError:
+    import os
+    import sys
+    dirname, filename = os.path.split(os.path.abspath(__file__))
+    d = os.path.join(dirname, "bindings")
+    sys.path.append(d)
+    from ofdmradar import ofdmradar_params, get_constellation, modulation_scheme, \
+        fft_effort, peak_extractor, peak_interpolation
+
+CARRIERS = 64
+SYMBOLS = 16
+PERI_CARRIERS = 128
+PERI_SYMBOLS = 32
+CP = 16
+SAMPLE_RATE = 20e6
+CARRIER_FREQ = 5.8e9
+C = 299792458.0
+
+
+def periodogram(range_bin, doppler_bin):
+    """ Periodogram of a point target at fractional bins, rows in FFT order, as the
+    receiver computes it: a windowed backward transform over the carriers centred
+    around DC and a windowed forward transform over the symbols, both zero padded """
+    k = np.arange(-CARRIERS // 2, CARRIERS // 2)
+    b = np.arange(PERI_CARRIERS)
+    carriers = np.hamming(CARRIERS) * np.exp(-2j * np.pi * k * range_bin / PERI_CARRIERS)
+    delay = np.exp(2j * np.pi * np.outer(b, k) / PERI_CARRIERS) @ carriers
+
+    s = np.arange(SYMBOLS)
+    f = np.arange(PERI_SYMBOLS)
+    symbols = np.hamming(SYMBOLS) * np.exp(2j * np.pi * s * doppler_bin / PERI_SYMBOLS)
+    doppler = np.exp(-2j * np.pi * np.outer(f, s) / PERI_SYMBOLS) @ symbols
+
+    return np.outer(doppler, delay).astype(np.complex64)
+
+
+class qa_peak_extractor(gr_unittest.TestCase):
+
+    def setUp(self):
+        self.tb = gr.top_block()
+        self.params = ofdmradar_params(CARRIERS, SYMBOLS, PERI_CARRIERS, PERI_SYMBOLS,
+                                       CP, 1, 0, 0,
+                                       get_constellation(modulation_scheme.QPSK), 0,
+                                       fft_effort.ESTIMATE)
+
+    def tearDown(self):
+        self.tb = None
+
+    def extract(self, fft_map, interpolation):
+        src = blocks.vector_source_c(fft_map.flatten().tolist(), False)
+        peaks = peak_extractor(self.params, 1, 20, interpolation, SAMPLE_RATE,
+                               CARRIER_FREQ)
+        dbg = blocks.message_debug()
+        self.tb.connect(src, peaks)
+        self.tb.msg_connect((peaks, "peaks"), (dbg, "store"))
+        self.tb.run()
+
+        self.assertEqual(dbg.num_messages(), 1)
+        msg = dbg.get_message(0)
+        return {key: pmt.f32vector_elements(
+                    pmt.dict_ref(msg, pmt.intern(key), pmt.PMT_NIL))
+                for key in ("range", "velocity", "range_bin", "doppler_bin", "power")}
+
+    def check_target(self, range_bin, doppler_bin, interpolation, tolerance):
+        peaks = self.extract(periodogram(range_bin, doppler_bin), interpolation)
+        self.assertEqual(len(peaks["range"]), 1)
+        self.assertAlmostEqual(peaks["range_bin"][0], range_bin, delta=tolerance)
+        self.assertAlmostEqual(peaks["doppler_bin"][0], doppler_bin, delta=tolerance)
+
+        # A range bin is carriers / peri_carriers samples of delay, measured from half
+        # a cyclic prefix before the symbol, a doppler bin 1 / peri_symbols cycles per
+        # symbol
+        metres_per_sample = C / (2 * SAMPLE_RATE)
+        expected_range = metres_per_sample * (
+            range_bin * CARRIERS / PERI_CARRIERS - CP // 2)
+        expected_velocity = (doppler_bin * SAMPLE_RATE /
+                             ((CARRIERS + CP) * PERI_SYMBOLS) * C / (2 * CARRIER_FREQ))
+        self.assertAlmostEqual(
+            peaks["range"][0], expected_range,
+            delta=tolerance * metres_per_sample * CARRIERS / PERI_CARRIERS)
+        self.assertAlmostEqual(
+            peaks["velocity"][0], expected_velocity,
+            delta=tolerance * abs(expected_velocity / doppler_bin))
+
+    def test_001_sinc(self):
+        for range_bin, doppler_bin in [(37.3, 3.4), (20.45, -5.2), (50.1, -0.35)]:
+            self.tb = gr.top_block()
+            self.check_target(range_bin, doppler_bin, peak_interpolation.SINC, 0.01)
+
+    def test_002_parabolic(self):
+        for range_bin, doppler_bin in [(37.3, 3.4), (20.45, -5.2)]:
+            self.tb = gr.top_block()
+            self.check_target(range_bin, doppler_bin, peak_interpolation.PARABOLIC,
+                              0.05)
+
+    def test_003_power_at_maximum(self):
+        # Refined between bins, the power is that of the maximum, the coherent sum of
+        # the windowed carriers and symbols
+        peaks = self.extract(periodogram(37.5, 3.5), peak_interpolation.SINC)
+        gain = np.sum(np.hamming(CARRIERS)) * np.sum(np.hamming(SYMBOLS))
+        self.assertAlmostEqual(peaks["power"][0] / gain ** 2, 1, delta=0.02)
+
+
+if __name__ == '__main__':
+    gr_unittest.run(qa_peak_extractor)